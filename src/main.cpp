@@ -39,6 +39,7 @@
 
 #include "DemoRunner.h"
 #include "GlobalObject.h"
+#include "GlobalSettings.h"
 #include "dataManagement/DataManager.h"
 #include "dataManagement/SSLErrorHandler.h"
 #include "geomaps/Airspace.h"
@@ -48,9 +49,13 @@
 #include "platform/FileExchange_Abstract.h"
 #include "platform/Notifier_Abstract.h"
 #include "platform/PlatformAdaptor_Abstract.h"
+#include "positioning/PositionProvider.h"
 #include "traffic/TrafficDataProvider.h"
+#include "traffic/TrafficDataSource_File.h"
+#include "traffic/TrafficDataSource_Simulate.h"
 #include "traffic/TrafficFactor_WithPosition.h"
 #include "weather/Station.h"
+#include "weather/WeatherDataProvider.h"
 #include <chrono>
 
 using namespace std::chrono_literals;
@@ -143,6 +148,20 @@ auto main(int argc, char *argv[]) -> int
     parser.addOption(googlePlayScreenshotOption);
     QCommandLineOption manualScreenshotOption(QStringLiteral("sm"), QCoreApplication::translate("main", "Run simulator and generate screenshots for the manual"));
     parser.addOption(manualScreenshotOption);
+    QCommandLineOption replaySpeedOption(QStringLiteral("replay-speed"), QCoreApplication::translate("main", "Replay FLARM simulator file at the given speed factor"), QStringLiteral("factor"));
+    parser.addOption(replaySpeedOption);
+    QCommandLineOption replayUnthrottledOption(QStringLiteral("replay-unthrottled"), QCoreApplication::translate("main", "Replay FLARM simulator file as fast as possible and log statistics"));
+    parser.addOption(replayUnthrottledOption);
+    QCommandLineOption simulateTrafficOption(QStringLiteral("simulate-traffic"), QCoreApplication::translate("main", "Simulate flight with the given number of synthetic traffic targets. For this session, the traffic data receiver is used as position source."), QStringLiteral("number"));
+    parser.addOption(simulateTrafficOption);
+    QCommandLineOption captureTrafficOption(QStringLiteral("capture-traffic"), QCoreApplication::translate("main", "Record raw data from traffic receivers to the given capture file"), QStringLiteral("fileName"));
+    parser.addOption(captureTrafficOption);
+    QCommandLineOption fuseTrafficOption(QStringLiteral("fuse-traffic"), QCoreApplication::translate("main", "Merge traffic from all traffic receivers that are connected"));
+    parser.addOption(fuseTrafficOption);
+    QCommandLineOption logTrafficLatencyOption(QStringLiteral("log-traffic-latency"), QCoreApplication::translate("main", "Measure latency of traffic data from reception to screen and log histograms on exit"));
+    parser.addOption(logTrafficLatencyOption);
+    QCommandLineOption weatherServerOption(QStringLiteral("weather-server"), QCoreApplication::translate("main", "Download weather data from the given server instead of aviationweather.gov"), QStringLiteral("URL"));
+    parser.addOption(weatherServerOption);
     parser.addPositionalArgument(QStringLiteral("[fileName]"), QCoreApplication::translate("main", "File to import."));
     parser.process(app);
     auto positionalArguments = parser.positionalArguments();
@@ -171,7 +190,29 @@ auto main(int argc, char *argv[]) -> int
     // Create mobile platform adaptor. We do this before creating the application engine because this also asks for permissions
     GlobalObject::platformAdaptor()->requestPermissionsSync();
     GlobalObject::platformAdaptor()->disableScreenSaver();
-    if (positionalArguments.length() == 1)
+    if (parser.isSet(captureTrafficOption))
+    {
+        GlobalObject::trafficDataProvider()->setCaptureFile(parser.value(captureTrafficOption));
+    }
+    if (parser.isSet(fuseTrafficOption))
+    {
+        GlobalObject::trafficDataProvider()->setFusion(true);
+    }
+    if (parser.isSet(weatherServerOption))
+    {
+        GlobalObject::weatherDataProvider()->setServerURL(QUrl(parser.value(weatherServerOption)));
+    }
+    if ((positionalArguments.length() == 1)
+        && (parser.isSet(replaySpeedOption) || parser.isSet(replayUnthrottledOption))
+        && Traffic::TrafficDataSource_File::containsFLARMSimulationData(positionalArguments[0]))
+    {
+        auto *source = new Traffic::TrafficDataSource_File(positionalArguments[0]);
+        source->setReplaySpeed(parser.value(replaySpeedOption).toDouble());
+        source->setUnthrottled(parser.isSet(replayUnthrottledOption));
+        GlobalObject::trafficDataProvider()->addDataSource(source); // Will take ownership of source
+        source->connectToTrafficReceiver();
+    }
+    else if (positionalArguments.length() == 1)
     {
         GlobalObject::fileExchange()->processFileOpenRequest(positionalArguments[0]);
     }
@@ -190,7 +231,31 @@ auto main(int argc, char *argv[]) -> int
     engine->rootContext()->setContextProperty(QStringLiteral("manual_location"), MANUAL_LOCATION );
     engine->rootContext()->setContextProperty(QStringLiteral("global"), new GlobalObject(engine) );
     engine->load(u"qrc:/qml/main.qml"_qs);
+    if (parser.isSet(logTrafficLatencyOption))
+    {
+        auto* window = qobject_cast<QQuickWindow*>(engine->rootObjects().value(0));
+        if (window != nullptr)
+        {
+            QObject::connect(window, &QQuickWindow::frameSwapped, GlobalObject::trafficDataProvider(), &Traffic::TrafficDataProvider::recordFrameSwapped, Qt::QueuedConnection);
+        }
+    }
 
+    // The simulator needs to be the position source. This is a session-only
+    // override that leaves the user setting untouched.
+    if (parser.isSet(simulateTrafficOption))
+    {
+        auto ownPosition = Positioning::PositionProvider::lastValidCoordinate();
+        ownPosition.setAltitude(Units::Distance::fromFT(3000).toM());
+        GlobalObject::positionProvider()->setPositioningByTrafficDataReceiverOverride(true);
+        auto* trafficSimulator = new Traffic::TrafficDataSource_Simulate();
+        trafficSimulator->setCoordinate(ownPosition);
+        trafficSimulator->setBarometricHeight(Units::Distance::fromFT(3000));
+        trafficSimulator->setTT(Units::Angle::fromDEG(90));
+        trafficSimulator->setGS(Units::Speed::fromKN(90));
+        trafficSimulator->setSyntheticTraffic(parser.value(simulateTrafficOption).toInt(), Units::Distance::fromNM(5.0), 0.4, 0.2);
+        GlobalObject::trafficDataProvider()->addDataSource(trafficSimulator); // Will take ownership of trafficSimulator
+        trafficSimulator->connectToTrafficReceiver();
+    }
     if (parser.isSet(googlePlayScreenshotOption))
     {
         GlobalObject::demoRunner()->setEngine(engine);
@@ -204,6 +269,10 @@ auto main(int argc, char *argv[]) -> int
 
     // Load GUI and enter event loop
     auto result = QGuiApplication::exec();
+    if (parser.isSet(logTrafficLatencyOption))
+    {
+        qInfo().noquote() << GlobalObject::trafficDataProvider()->latencyReport();
+    }
 
     // Ensure that the engine does not hold objects that will interfere when we close down.
     delete engine;
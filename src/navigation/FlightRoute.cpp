@@ -118,11 +118,19 @@ auto Navigation::FlightRoute::summary() const -> QString
     auto time = Units::Time::fromS(0.0);
     auto fuel = Units::Volume::fromL(0.0);
 
+    // If the user has not specified the wind, every leg uses the wind
+    // interpolated from METARs along the route, where available
+    auto windSpecified = wind.speed().isFinite() && wind.directionFrom().isFinite();
+    bool hasLegWithReportedWind = false;
     for(const auto& _leg : m_legs) {
         dist += _leg.distance();
         if (dist.toM() > 100) {
-            time += _leg.ETE(wind, aircraft);
-            fuel += _leg.Fuel(wind, aircraft);
+            auto legWind = _leg.estimatedWind(wind);
+            if (!windSpecified && legWind.speed().isFinite() && legWind.directionFrom().isFinite()) {
+                hasLegWithReportedWind = true;
+            }
+            time += _leg.ETE(legWind, aircraft);
+            fuel += _leg.Fuel(legWind, aircraft);
         }
     }
     if (!dist.isFinite()) {
@@ -138,7 +146,6 @@ auto Navigation::FlightRoute::summary() const -> QString
         result += QStringLiteral(" • %1").arg(aircraft.volumeToString(fuel));
     }
 
-
     QStringList complaints;
     if ( !aircraft.cruiseSpeed().isFinite() ) {
         complaints += tr("Cruise speed not specified.");
@@ -146,11 +153,15 @@ auto Navigation::FlightRoute::summary() const -> QString
     if (!aircraft.fuelConsumption().isFinite()) {
         complaints += tr("Fuel consumption not specified.");
     }
-    if (!wind.speed().isFinite()) {
-        complaints += tr("Wind speed not specified.");
-    }
-    if (!wind.directionFrom().isFinite()) {
-        complaints += tr("Wind direction not specified.");
+    if (hasLegWithReportedWind) {
+        complaints += tr("Wind not specified, using surface wind from METARs where available.");
+    } else {
+        if (!wind.speed().isFinite()) {
+            complaints += tr("Wind speed not specified.");
+        }
+        if (!wind.directionFrom().isFinite()) {
+            complaints += tr("Wind direction not specified.");
+        }
     }
 
     if (!complaints.isEmpty()) {
@@ -118,7 +118,9 @@ namespace Navigation
          *  with HTML complaints if wind or aircraft data was missing.
          *
          *  The summary is computed for the aircraft and wind that are presently
-         *  set in the global Navigator class.
+         *  set in the global Navigator class.  If no wind is set, the wind on
+         *  each leg is interpolated from METARs along the route, where
+         *  available, see Leg::estimatedWind().
          */
         Q_PROPERTY(QString summary READ summary NOTIFY summaryChanged)
 
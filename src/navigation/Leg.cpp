@@ -23,6 +23,7 @@
 #include "GlobalObject.h"
 #include "GlobalSettings.h"
 #include "navigation/Navigator.h"
+#include "weather/WeatherDataProvider.h"
 #include <utility>
 
 
@@ -174,9 +175,12 @@ auto Navigation::Leg::description(Weather::Wind wind, const Navigation::Aircraft
         return {};
     }
 
+    // Use surface wind from METARs if the wind is not specified
+    auto legWind = estimatedWind(wind);
+
     QString result;
     result += QStringLiteral("%1").arg( aircraft.horizontalDistanceToString(distance()) );
-    auto _time = ETE(wind, aircraft);
+    auto _time = ETE(legWind, aircraft);
     if (_time.isFinite()) {
         result += QStringLiteral(" • ETE %1 h").arg(_time.toHoursAndMinutes());
     }
@@ -184,15 +188,39 @@ auto Navigation::Leg::description(Weather::Wind wind, const Navigation::Aircraft
     if (qIsFinite(TCInDEG)) {
         result += QStringLiteral(" • TC %1°").arg(qRound(TCInDEG));
     }
-    double THInDEG = TH(wind, aircraft).toDEG();
+    double THInDEG = TH(legWind, aircraft).toDEG();
     if (qIsFinite(THInDEG)) {
         result += QStringLiteral(" • TH %1°").arg(qRound(THInDEG));
     }
+    auto windSpecified = wind.speed().isFinite() && wind.directionFrom().isFinite();
+    if (!windSpecified && legWind.speed().isFinite() && legWind.directionFrom().isFinite()) {
+        result += QStringLiteral(" • ") + tr("METAR surface wind");
+    }
 
     return result;
 }
 
 
+auto Navigation::Leg::estimatedWind(Weather::Wind wind) const -> Weather::Wind
+{
+    if (wind.speed().isFinite() && wind.directionFrom().isFinite()) {
+        return wind;
+    }
+    if (!isValid()) {
+        return wind;
+    }
+
+    auto start = m_start.coordinate();
+    auto end = m_end.coordinate();
+    auto midpoint = start.atDistanceAndAzimuth(start.distanceTo(end)/2.0, start.azimuthTo(end));
+    auto interpolatedWind = GlobalObject::weatherDataProvider()->corridorWind(midpoint);
+    if (interpolatedWind.speed().isFinite() && interpolatedWind.directionFrom().isFinite()) {
+        return interpolatedWind;
+    }
+    return wind;
+}
+
+
 auto Navigation::Leg::hasDataForWindTriangle(Weather::Wind wind, const Navigation::Aircraft& aircraft) -> bool
 {
 
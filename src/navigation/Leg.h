@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <QCoreApplication>
 #include <QGeoPath>
 #include <QQmlEngine>
 
@@ -37,6 +38,7 @@ namespace Navigation {
 class Leg {
     Q_GADGET
     QML_VALUE_TYPE(leg)
+    Q_DECLARE_TR_FUNCTIONS(Navigation::Leg)
 
 public:
 
@@ -126,7 +128,9 @@ public:
 
     /*! \brief Brief description of Dist ETE, TC and THGetter function for property of the same name
      *
-     *  @param wind Estimated wind
+     *  @param wind Estimated wind. If the wind is not specified, the
+     *  description uses estimatedWind() and says so if surface wind from
+     *  METARs is used.
      *
      *  @param aircraft Aircraft in use
      *
@@ -134,6 +138,19 @@ public:
      */
     Q_INVOKABLE [[nodiscard]] QString description(Weather::Wind wind, const Navigation::Aircraft& aircraft) const;
 
+    /*! \brief Estimated wind for leg
+     *
+     *  If the wind given as a parameter has finite speed and direction, it is
+     *  returned unchanged.  Otherwise, this method returns the wind at the
+     *  midpoint of the leg, as interpolated from METARs by
+     *  Weather::WeatherDataProvider::corridorWind(), if available.
+     *
+     *  @param wind Wind estimated by the user, typically Navigator::wind()
+     *
+     *  @returns Wind to be used for computations on this leg
+     */
+    Q_INVOKABLE [[nodiscard]] Weather::Wind estimatedWind(Weather::Wind wind) const;
+
     /*! \brief ETE for leg
      *
      *  @param wind Estimated wind
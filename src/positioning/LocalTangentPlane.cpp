@@ -0,0 +1,142 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <QtMath>
+
+#include "positioning/LocalTangentPlane.h"
+
+
+// Static Helper functions
+
+// WGS84 ellipsoid: semi-major axis in meters and square of the eccentricity
+const double wgs84A = 6378137.0;
+const double wgs84E2 = 6.69437999014e-3;
+
+
+// Member functions
+
+Positioning::LocalTangentPlane::LocalTangentPlane(const QGeoCoordinate& origin)
+    : m_origin(origin)
+{
+    if (!m_origin.isValid()) {
+        return;
+    }
+
+    // Meridional and prime vertical radii of curvature at the origin
+    auto latRAD = qDegreesToRadians(m_origin.latitude());
+    auto sinLat = qSin(latRAD);
+    auto w2 = 1.0 - wgs84E2*sinLat*sinLat;
+    auto M = wgs84A*(1.0-wgs84E2)/(w2*qSqrt(w2));
+    auto N = wgs84A/qSqrt(w2);
+    if (m_origin.type() == QGeoCoordinate::Coordinate3D) {
+        m_originAltitude = m_origin.altitude();
+    }
+
+    m_metersPerDegreeLatitude = qDegreesToRadians(M+m_originAltitude);
+    m_metersPerDegreeLongitude = qDegreesToRadians((N+m_originAltitude)*qCos(latRAD));
+}
+
+
+auto Positioning::LocalTangentPlane::azimuth(const ENU& from, const ENU& to) -> Units::Angle
+{
+    return Units::Angle::fromRAD(qAtan2(to.east-from.east, to.north-from.north));
+}
+
+
+auto Positioning::LocalTangentPlane::hDist(const ENU& from, const ENU& to) -> Units::Distance
+{
+    auto dEast = to.east-from.east;
+    auto dNorth = to.north-from.north;
+    return Units::Distance::fromM(qSqrt(dEast*dEast + dNorth*dNorth));
+}
+
+
+auto Positioning::LocalTangentPlane::hDist(const QGeoCoordinate& from, const QGeoCoordinate& to) const -> Units::Distance
+{
+    if (!isValid() || !from.isValid() || !to.isValid()) {
+        return {};
+    }
+
+    auto fromPoint = toENU(from);
+    auto toPoint = toENU(to);
+    if ((hDist({}, fromPoint) <= maxAccurateDistance) && (hDist({}, toPoint) <= maxAccurateDistance)) {
+        return hDist(fromPoint, toPoint);
+    }
+    return Units::Distance::fromM(from.distanceTo(to));
+}
+
+
+void Positioning::LocalTangentPlane::refresh(const QGeoCoordinate& position)
+{
+    if (!position.isValid()) {
+        return;
+    }
+    if (isValid() && (hDist({}, toENU(position)) <= refreshDistance)) {
+        return;
+    }
+    *this = LocalTangentPlane(position);
+}
+
+
+auto Positioning::LocalTangentPlane::toCoordinate(const ENU& enu) const -> QGeoCoordinate
+{
+    if (!isValid()) {
+        return {};
+    }
+
+    auto longitude = m_origin.longitude() + enu.east/m_metersPerDegreeLongitude;
+    if (longitude > 180.0) {
+        longitude -= 360.0;
+    }
+    if (longitude < -180.0) {
+        longitude += 360.0;
+    }
+    QGeoCoordinate result(m_origin.latitude() + enu.north/m_metersPerDegreeLatitude, longitude);
+    if (qIsFinite(enu.up)) {
+        result.setAltitude(m_originAltitude + enu.up);
+    }
+    return result;
+}
+
+
+auto Positioning::LocalTangentPlane::toENU(const QGeoCoordinate& coordinate) const -> ENU
+{
+    if (!isValid() || !coordinate.isValid()) {
+        return {qQNaN(), qQNaN(), qQNaN()};
+    }
+
+    auto dLongitude = coordinate.longitude() - m_origin.longitude();
+    if (dLongitude > 180.0) {
+        dLongitude -= 360.0;
+    }
+    if (dLongitude < -180.0) {
+        dLongitude += 360.0;
+    }
+
+    ENU result;
+    result.east = dLongitude*m_metersPerDegreeLongitude;
+    result.north = (coordinate.latitude() - m_origin.latitude())*m_metersPerDegreeLatitude;
+    if (coordinate.type() == QGeoCoordinate::Coordinate3D) {
+        result.up = coordinate.altitude() - m_originAltitude;
+    } else {
+        result.up = qQNaN();
+    }
+    return result;
+}
@@ -0,0 +1,176 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QGeoCoordinate>
+
+#include "units/Angle.h"
+#include "units/Distance.h"
+
+
+namespace Positioning {
+
+/*! \brief Local tangent plane
+ *
+ *  This class implements a local east-north-up (ENU) frame, anchored at an
+ *  origin on the WGS84 ellipsoid.  Coordinates are converted to and from the
+ *  frame using the radii of curvature of the ellipsoid at the origin, so that
+ *  every conversion is a handful of multiply-adds, without any trigonometry.
+ *  The error of the approximation grows quadratically with the distance from
+ *  the origin, and with the tangent of the latitude.  At mid latitudes, it is
+ *  less than about ten meters for points within maxAccurateDistance of the
+ *  origin, but reaches about 150 meters at 20 NM, the range up to which
+ *  traffic is shown.  Relative positions of nearby traffic, which matter for
+ *  display and conflict prediction, are therefore accurate.  Where distances
+ *  to far traffic are needed, use the method hDist() that takes geographic
+ *  coordinates, which falls back to the great circle distance.
+ *
+ *  The frame is meant to be anchored at the own aircraft, and re-anchored with
+ *  refresh() whenever the own aircraft has moved more than refreshDistance
+ *  away from the origin.
+ */
+class LocalTangentPlane {
+
+public:
+    /*! \brief Position in the local tangent plane, in meters */
+    struct ENU
+    {
+        /*! \brief Distance east of the origin */
+        double east {0.0};
+
+        /*! \brief Distance north of the origin */
+        double north {0.0};
+
+        /*! \brief Height above the origin, or above the ellipsoid if the origin
+         *  has no altitude. NaN if unknown */
+        double up {0.0};
+    };
+
+    /*! \brief Constructs an invalid frame */
+    LocalTangentPlane() = default;
+
+    /*! \brief Constructs a frame anchored at the given origin
+     *
+     *  @param origin Origin of the frame. If the origin is not valid, the frame
+     *  will be invalid.
+     */
+    explicit LocalTangentPlane(const QGeoCoordinate& origin);
+
+    /*! \brief Distance after which refresh() re-anchors the frame */
+    static constexpr Units::Distance refreshDistance = Units::Distance::fromM(1000.0);
+
+    /*! \brief Distance from the origin up to which the frame is accurate to within a few meters */
+    static constexpr Units::Distance maxAccurateDistance = Units::Distance::fromM(10000.0);
+
+    /*! \brief Azimuth from one point to another
+     *
+     *  @param from Starting point
+     *
+     *  @param to End point
+     *
+     *  @returns True azimuth from 'from' to 'to'
+     */
+    [[nodiscard]] static auto azimuth(const ENU& from, const ENU& to) -> Units::Angle;
+
+    /*! \brief Horizontal distance between two points
+     *
+     *  @param from Starting point
+     *
+     *  @param to End point
+     *
+     *  @returns Horizontal distance
+     */
+    [[nodiscard]] static auto hDist(const ENU& from, const ENU& to) -> Units::Distance;
+
+    /*! \brief Horizontal distance between two geographic coordinates
+     *
+     *  The distance is computed in the frame if both points are within
+     *  maxAccurateDistance of the origin.  Otherwise, the great circle
+     *  distance is computed, which requires trigonometric functions.
+     *
+     *  @param from Starting point
+     *
+     *  @param to End point
+     *
+     *  @returns Horizontal distance. Invalid if the frame or one of the
+     *  coordinates is invalid.
+     */
+    [[nodiscard]] auto hDist(const QGeoCoordinate& from, const QGeoCoordinate& to) const -> Units::Distance;
+
+    /*! \brief Validity
+     *
+     *  @returns True if the frame has a valid origin
+     */
+    [[nodiscard]] auto isValid() const -> bool
+    {
+        return m_origin.isValid();
+    }
+
+    /*! \brief Origin of the frame
+     *
+     *  @returns Origin of the frame
+     */
+    [[nodiscard]] auto origin() const -> QGeoCoordinate
+    {
+        return m_origin;
+    }
+
+    /*! \brief Re-anchor frame if necessary
+     *
+     *  If the frame is invalid, or if the position is more than
+     *  refreshDistance away from the origin, the frame is re-anchored at the
+     *  given position.  Otherwise, this method does nothing.
+     *
+     *  @param position Current position of own aircraft
+     */
+    void refresh(const QGeoCoordinate& position);
+
+    /*! \brief Convert from the frame to geographic coordinates
+     *
+     *  @param enu Position in the local tangent plane
+     *
+     *  @returns Geographic coordinate. The coordinate has an altitude if
+     *  enu.up is finite.  Invalid if the frame is invalid.
+     */
+    [[nodiscard]] auto toCoordinate(const ENU& enu) const -> QGeoCoordinate;
+
+    /*! \brief Convert from geographic coordinates to the frame
+     *
+     *  @param coordinate Geographic coordinate
+     *
+     *  @returns Position in the local tangent plane. The component up is NaN if
+     *  the altitude of the coordinate is not known.  All components are NaN if
+     *  the frame or the coordinate is invalid.
+     */
+    [[nodiscard]] auto toENU(const QGeoCoordinate& coordinate) const -> ENU;
+
+private:
+    QGeoCoordinate m_origin;
+
+    // Altitude of the origin, or 0.0 if the origin has no altitude
+    double m_originAltitude {0.0};
+
+    // Meters per degree of latitude and longitude at the origin
+    double m_metersPerDegreeLatitude {qQNaN()};
+    double m_metersPerDegreeLongitude {qQNaN()};
+};
+
+} // namespace Positioning
@@ -84,7 +84,7 @@ void Positioning::PositionProvider::onPositionUpdated()
     QString source;
 
 
-    if (GlobalObject::globalSettings()->positioningByTrafficDataReceiver())
+    if (m_positioningByTrafficDataReceiverOverride || GlobalObject::globalSettings()->positioningByTrafficDataReceiver())
     {
 
         // Priority #1: Traffic data provider
@@ -211,6 +211,17 @@ void Positioning::PositionProvider::setLastValidCoordinate(const QGeoCoordinate
 }
 
 
+void Positioning::PositionProvider::setPositioningByTrafficDataReceiverOverride(bool newOverride)
+{
+    if (m_positioningByTrafficDataReceiverOverride == newOverride)
+    {
+        return;
+    }
+    m_positioningByTrafficDataReceiverOverride = newOverride;
+    onPositionUpdated();
+}
+
+
 void Positioning::PositionProvider::setLastValidTT(Units::Angle newTT)
 {
     if (!newTT.isFinite()) {
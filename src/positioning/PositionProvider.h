@@ -98,6 +98,17 @@ public:
      */
     static auto lastValidTT() -> Units::Angle;
 
+    /*! \brief Prefer the traffic data receiver for the current session
+     *
+     *  If set, the traffic data receiver is the preferred position source,
+     *  regardless of GlobalSettings::positioningByTrafficDataReceiver.  Unlike
+     *  that setting, the override is not stored and ends with the program.  It
+     *  is used with traffic data simulators.
+     *
+     *  @param newOverride True if the traffic data receiver shall be preferred
+     */
+    void setPositioningByTrafficDataReceiverOverride(bool newOverride);
+
 signals:
     /*! \brief Notifier signal */
     void lastValidTTChanged(Units::Angle);
@@ -145,6 +156,9 @@ private:
 
     QGeoCoordinate m_lastValidCoordinate {EDTF_lat, EDTF_lon, EDTF_ele};
     Units::Angle m_lastValidTT {};
+
+    // Session-only override of GlobalSettings::positioningByTrafficDataReceiver
+    bool m_positioningByTrafficDataReceiverOverride {false};
 };
 
 } // namespace Positioning
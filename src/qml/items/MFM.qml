@@ -376,6 +376,18 @@ Item {
             path: visible ? [PositionProvider.lastValidCoordinate, Navigator.remainingRouteInfo.nextWP.coordinate] : []
         }
 
+        MapItemView { // Trails of traffic opponents
+            model: global.trafficDataProvider().trafficObjects4QML
+            delegate: Component {
+                MapPolyline {
+                    visible: model.modelData.valid
+                    line.width: 1
+                    line.color: "gray"
+                    path: model.modelData.trail
+                }
+            }
+        }
+
         MapItemView { // Traffic opponents
             model: global.trafficDataProvider().trafficObjects4QML
             delegate: Component {
@@ -548,6 +560,36 @@ Choose <strong>Library/Maps and Data</strong> to open the map management page.</
         }
     }
 
+    Pane { // Traffic alarm, as issued by the traffic receiver or as predicted by the app
+        id: trafficAlarm
+
+        property var receiverWarning: global.trafficDataProvider().warning
+        property var predictedWarning: global.trafficDataProvider().predictedWarning
+
+        // Alarms of the traffic receiver take precedence over predicted conflicts
+        property bool showPredicted: (receiverWarning.alarmLevel() < 1) && (predictedWarning.alarmLevel() > 0)
+        property int alarmLevel: showPredicted ? predictedWarning.alarmLevel() : receiverWarning.alarmLevel()
+
+        anchors.horizontalCenter: parent.horizontalCenter
+        anchors.top: menuButton.bottom
+        anchors.topMargin: 0.5*view.font.pixelSize
+        width: Math.min(implicitWidth, parent.width*0.8)
+
+        Material.elevation: 2
+        Material.background: (alarmLevel >= 2) ? Material.Red : Material.Orange
+        visible: alarmLevel > 0
+
+        Label {
+            width: trafficAlarm.availableWidth
+            wrapMode: Text.WordWrap
+            color: "white"
+            font.bold: true
+
+            text: trafficAlarm.showPredicted ? qsTr("Predicted conflict") + " • " + trafficAlarm.predictedWarning.description()
+                                             : trafficAlarm.receiverWarning.description()
+        }
+    }
+
     RoundButton {
         id: menuButton
         icon.source: "/icons/material/ic_menu.svg"
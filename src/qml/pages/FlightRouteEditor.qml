@@ -155,9 +155,10 @@ Page {
                 Layout.fillWidth: true
                 enabled: false
                 text: {
-                    // Mention units
+                    // Mention units and stations used for wind interpolation
                     Navigator.aircraft.horizontalDistanceUnit
                     Navigator.aircraft.fuelConsumptionUnit
+                    WeatherDataProvider.corridorStations
 
                     if (leg === null)
                         return ""
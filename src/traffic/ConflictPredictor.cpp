@@ -0,0 +1,188 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <QtMath>
+
+#include "traffic/ConflictPredictor.h"
+
+
+// Static Helper functions
+
+// Velocity in meters per second, as north, east and up components
+void velocityNEU(const QGeoPositionInfo& info, double& vNorth, double& vEast, double& vUp)
+{
+    vNorth = 0.0;
+    vEast = 0.0;
+    vUp = 0.0;
+    if (info.hasAttribute(QGeoPositionInfo::GroundSpeed) && info.hasAttribute(QGeoPositionInfo::Direction)) {
+        auto GS = info.attribute(QGeoPositionInfo::GroundSpeed);
+        auto TT = qDegreesToRadians(info.attribute(QGeoPositionInfo::Direction));
+        if (qIsFinite(GS) && qIsFinite(TT)) {
+            vNorth = GS*qCos(TT);
+            vEast = GS*qSin(TT);
+        }
+    }
+    if (info.hasAttribute(QGeoPositionInfo::VerticalSpeed)) {
+        auto VS = info.attribute(QGeoPositionInfo::VerticalSpeed);
+        if (qIsFinite(VS)) {
+            vUp = VS;
+        }
+    }
+}
+
+
+// Member functions
+
+void Traffic::ConflictPredictor::clear()
+{
+    m_north.clear();
+    m_east.clear();
+    m_up.clear();
+    m_vNorth.clear();
+    m_vEast.clear();
+    m_vUp.clear();
+    m_tCPA.clear();
+    m_hDistCPA.clear();
+    m_vDistCPA.clear();
+}
+
+
+void Traffic::ConflictPredictor::reserve(qsizetype numTargets)
+{
+    m_north.reserve(numTargets);
+    m_east.reserve(numTargets);
+    m_up.reserve(numTargets);
+    m_vNorth.reserve(numTargets);
+    m_vEast.reserve(numTargets);
+    m_vUp.reserve(numTargets);
+    m_tCPA.reserve(numTargets);
+    m_hDistCPA.reserve(numTargets);
+    m_vDistCPA.reserve(numTargets);
+}
+
+
+void Traffic::ConflictPredictor::setOwnship(const QGeoPositionInfo& ownship)
+{
+    m_localTangentPlane = Positioning::LocalTangentPlane(ownship.coordinate());
+    velocityNEU(ownship, m_ownVNorth, m_ownVEast, m_ownVUp);
+    m_ownTrack = ownship.hasAttribute(QGeoPositionInfo::Direction) ? ownship.attribute(QGeoPositionInfo::Direction) : qQNaN();
+}
+
+
+auto Traffic::ConflictPredictor::addTarget(const QGeoPositionInfo& target) -> qsizetype
+{
+    auto coordinate = target.coordinate();
+    if (!coordinate.isValid() || !m_localTangentPlane.isValid()) {
+        return -1;
+    }
+
+    // Convert to local tangent plane. If the altitude of own aircraft is not
+    // known, then the vertical distance is not known either.
+    auto enu = m_localTangentPlane.toENU(coordinate);
+    m_north.push_back(enu.north);
+    m_east.push_back(enu.east);
+    if (m_localTangentPlane.origin().type() == QGeoCoordinate::Coordinate3D) {
+        m_up.push_back(enu.up);
+    } else {
+        m_up.push_back(qQNaN());
+    }
+
+    // Relative velocity
+    double vNorth = 0.0;
+    double vEast = 0.0;
+    double vUp = 0.0;
+    velocityNEU(target, vNorth, vEast, vUp);
+    m_vNorth.push_back(vNorth-m_ownVNorth);
+    m_vEast.push_back(vEast-m_ownVEast);
+    m_vUp.push_back(vUp-m_ownVUp);
+
+    return size()-1;
+}
+
+
+auto Traffic::ConflictPredictor::predict() -> qsizetype
+{
+    auto numTargets = m_north.size();
+    m_tCPA.resize(numTargets);
+    m_hDistCPA.resize(numTargets);
+    m_vDistCPA.resize(numTargets);
+
+    // Main loop. This loop does not branch and works on contiguous arrays only.
+    // Targets that are not approaching, that is, whose CPA lies in the past,
+    // get an infinite distance at CPA. Otherwise, targets that are close but
+    // diverging, such as gliders sharing a thermal, would be reported as
+    // conflicts with CPA now.
+    const auto* north = m_north.data();
+    const auto* east = m_east.data();
+    const auto* up = m_up.data();
+    const auto* vNorth = m_vNorth.data();
+    const auto* vEast = m_vEast.data();
+    const auto* vUp = m_vUp.data();
+    auto* tCPA = m_tCPA.data();
+    auto* hDistCPA = m_hDistCPA.data();
+    auto* vDistCPA = m_vDistCPA.data();
+    for(size_t i=0; i<numTargets; i++) {
+        auto v2 = vNorth[i]*vNorth[i] + vEast[i]*vEast[i];
+        auto t = -(north[i]*vNorth[i] + east[i]*vEast[i])/qMax(v2, 1e-6);
+        auto approaching = (t > 0.0);
+        t = qBound(0.0, t, horizon);
+        auto dNorth = north[i] + vNorth[i]*t;
+        auto dEast = east[i] + vEast[i]*t;
+        tCPA[i] = t;
+        hDistCPA[i] = approaching ? qSqrt(dNorth*dNorth + dEast*dEast) : qInf();
+        vDistCPA[i] = up[i] + vUp[i]*t;
+    }
+
+    // Find most critical conflict. Targets with unknown vertical distance are
+    // considered conflicting if the horizontal distance is too small.
+    qsizetype result = -1;
+    auto hSep = horizontalSeparation.toM();
+    auto vSep = verticalSeparation.toM();
+    for(size_t i=0; i<numTargets; i++) {
+        if ((hDistCPA[i] >= hSep) || (qAbs(vDistCPA[i]) >= vSep)) {
+            continue;
+        }
+        if ((result < 0) || (tCPA[i] < tCPA[result])) {
+            result = static_cast<qsizetype>(i);
+        }
+    }
+    return result;
+}
+
+
+auto Traffic::ConflictPredictor::warning(qsizetype index) const -> Traffic::Warning
+{
+    if ((index < 0) || (index >= size()) || (index >= static_cast<qsizetype>(m_tCPA.size()))) {
+        return Traffic::Warning();
+    }
+
+    int alarmLevel = 1;
+    if (m_tCPA[index] <= 12.0) {
+        alarmLevel = 2;
+    }
+    if (m_tCPA[index] <= 8.0) {
+        alarmLevel = 3;
+    }
+
+    Positioning::LocalTangentPlane::ENU target {m_east[index], m_north[index], m_up[index]};
+    auto hDist = Positioning::LocalTangentPlane::hDist({}, target);
+    auto relativeBearing = Positioning::LocalTangentPlane::azimuth({}, target) - Units::Angle::fromDEG(m_ownTrack);
+    return Traffic::Warning(alarmLevel, relativeBearing, hDist, Units::Distance::fromM(m_up[index]));
+}
@@ -0,0 +1,182 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QGeoPositionInfo>
+#include <vector>
+
+#include "positioning/LocalTangentPlane.h"
+#include "traffic/Warning.h"
+
+
+namespace Traffic {
+
+/*! \brief Prediction of the closest point of approach
+ *
+ *  This class predicts, for a list of traffic targets, time and distance at
+ *  the closest point of approach (CPA) to the own aircraft, assuming that own
+ *  aircraft and targets continue with constant velocity.  The computation is
+ *  done in a Positioning::LocalTangentPlane centered at the own aircraft.
+ *
+ *  Targets are stored in a structure-of-arrays layout, so that the main loop
+ *  in predict() runs over contiguous arrays of doubles and can be vectorized
+ *  by the compiler.
+ *
+ *  Typical use: call setOwnship(), then addTarget() for all targets, then
+ *  predict(). Call clear() before the next round.
+ */
+class ConflictPredictor {
+
+public:
+    /*! \brief Prediction horizon
+     *
+     *  Conflicts are predicted this many seconds ahead. This is considerably
+     *  longer than the 18 seconds used by FLARM devices for their first alarm
+     *  level.
+     */
+    static constexpr double horizon = 30.0;
+
+    /*! \brief Horizontal distance at CPA that is considered a conflict */
+    static constexpr Units::Distance horizontalSeparation = Units::Distance::fromM(300.0);
+
+    /*! \brief Vertical distance at CPA that is considered a conflict */
+    static constexpr Units::Distance verticalSeparation = Units::Distance::fromM(150.0);
+
+    /*! \brief Remove all targets */
+    void clear();
+
+    /*! \brief Reserve space for targets
+     *
+     *  @param numTargets Expected number of targets
+     */
+    void reserve(qsizetype numTargets);
+
+    /*! \brief Set position and velocity of own aircraft
+     *
+     *  @param ownship Position info of own aircraft. Ground speed and track are
+     *  taken from the attributes of the position info, if set. Otherwise, the
+     *  own aircraft is assumed to be stationary.
+     */
+    void setOwnship(const QGeoPositionInfo& ownship);
+
+    /*! \brief Add target
+     *
+     *  @param target Position info of target. Targets with invalid coordinate
+     *  are ignored.
+     *
+     *  @returns Index of the target, or -1 if the target was ignored
+     */
+    auto addTarget(const QGeoPositionInfo& target) -> qsizetype;
+
+    /*! \brief Number of targets
+     *
+     *  @returns Number of targets
+     */
+    [[nodiscard]] auto size() const -> qsizetype
+    {
+        return static_cast<qsizetype>(m_north.size());
+    }
+
+    /*! \brief Compute closest points of approach for all targets
+     *
+     *  @returns Index of the most critical predicted conflict, that is, the
+     *  target with the earliest closest point of approach within the
+     *  prediction horizon that violates horizontal and vertical separation.
+     *  Targets that are not approaching own aircraft are never considered
+     *  conflicting, even if they are currently close.  Returns -1 if there is
+     *  no such target.
+     */
+    auto predict() -> qsizetype;
+
+    /*! \brief Time to closest point of approach
+     *
+     *  @param index Index of target, as returned by addTarget()
+     *
+     *  @returns Time to CPA in seconds, between 0 and horizon
+     */
+    [[nodiscard]] auto timeToCPA(qsizetype index) const -> double
+    {
+        return m_tCPA[index];
+    }
+
+    /*! \brief Horizontal distance at closest point of approach
+     *
+     *  @param index Index of target, as returned by addTarget()
+     *
+     *  @returns Horizontal distance at CPA. Infinite if the target is not
+     *  approaching own aircraft.
+     */
+    [[nodiscard]] auto hDistCPA(qsizetype index) const -> Units::Distance
+    {
+        return Units::Distance::fromM(m_hDistCPA[index]);
+    }
+
+    /*! \brief Vertical distance at closest point of approach
+     *
+     *  @param index Index of target, as returned by addTarget()
+     *
+     *  @returns Vertical distance at CPA. Positive values mean that the target
+     *  is above own aircraft. NaN if the altitude of own aircraft or target is
+     *  not known.
+     */
+    [[nodiscard]] auto vDistCPA(qsizetype index) const -> Units::Distance
+    {
+        return Units::Distance::fromM(m_vDistCPA[index]);
+    }
+
+    /*! \brief Traffic warning for a predicted conflict
+     *
+     *  The alarm level is 3 if the CPA is at most 8 seconds ahead, 2 if it is
+     *  at most 12 seconds ahead and 1 otherwise.  Horizontal and vertical
+     *  distance and relative bearing describe the present position of the
+     *  target, as with warnings issued by FLARM devices.
+     *
+     *  @param index Index of target, as returned by predict(). If the index is
+     *  negative, an invalid warning is returned.
+     *
+     *  @returns Traffic warning
+     */
+    [[nodiscard]] auto warning(qsizetype index) const -> Traffic::Warning;
+
+private:
+    // Own aircraft. The local tangent plane is centered at own aircraft.
+    Positioning::LocalTangentPlane m_localTangentPlane;
+    double m_ownVNorth {0.0};
+    double m_ownVEast {0.0};
+    double m_ownVUp {0.0};
+    double m_ownTrack {qQNaN()};
+
+    // Targets, positions in meters relative to own aircraft in the local
+    // tangent plane, velocities in meters per second
+    std::vector<double> m_north;
+    std::vector<double> m_east;
+    std::vector<double> m_up;
+    std::vector<double> m_vNorth;
+    std::vector<double> m_vEast;
+    std::vector<double> m_vUp;
+
+    // Results of predict()
+    std::vector<double> m_tCPA;
+    std::vector<double> m_hDistCPA;
+    std::vector<double> m_vDistCPA;
+};
+
+} // namespace Traffic
@@ -20,6 +20,10 @@
 
 #include <QCoreApplication>
 #include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
 #include "GlobalObject.h"
 #include "dataManagement/DataManager.h"
@@ -28,13 +32,45 @@
 
 Traffic::FlarmnetDB::FlarmnetDB(QObject* parent) : QObject(parent)
 {
+    connect(&m_batchWatcher, &QFutureWatcher<QHash<QString, QString>>::finished, this, &Traffic::FlarmnetDB::onBatchFinished);
+    connect(&m_openWatcher, &QFutureWatcher<std::shared_ptr<const Database>>::finished, this, &Traffic::FlarmnetDB::onOpenFinished);
     QTimer::singleShot(0, this, &Traffic::FlarmnetDB::deferredInitialization);
 }
 
 
-void Traffic::FlarmnetDB::clearCache()
+auto Traffic::FlarmnetDB::cachedRegistration(const QString& key) -> QString
+{
+    if (key.contains(QLatin1String("!"))) {
+        auto result = key.section('!', -1, -1);
+        return result;
+    }
+
+    // Check if key exists in the cache
+    auto* cachedValue = m_cache[key];
+    if (cachedValue != nullptr) {
+        return *cachedValue;
+    }
+
+    // Queue key for lookup. If the database is still being opened, the key
+    // is looked up once the database is available.
+    if ((m_database != nullptr) || m_opening) {
+        m_pendingKeys.insert(key);
+        startBatch();
+    }
+    return {};
+}
+
+
+void Traffic::FlarmnetDB::closeDatabase()
 {
     m_cache.clear();
+    m_pendingKeys.clear();
+
+    // A running batch keeps its own reference to the database, so that the
+    // file stays mapped until the batch has finished. If the database is
+    // still being opened, the result will be discarded.
+    m_database.reset();
+    m_opening = false;
 }
 
 
@@ -71,26 +107,16 @@ void Traffic::FlarmnetDB::findFlarmnetDBDownloadable()
     }
 
     if (flarmnetDBDownloadable != nullptr) {
-        disconnect(flarmnetDBDownloadable, &DataManagement::Downloadable_Abstract::fileContentChanged, this, &Traffic::FlarmnetDB::clearCache);
+        disconnect(flarmnetDBDownloadable, &DataManagement::Downloadable_SingleFile::aboutToChangeFile, this, &Traffic::FlarmnetDB::closeDatabase);
+        disconnect(flarmnetDBDownloadable, &DataManagement::Downloadable_Abstract::fileContentChanged, this, &Traffic::FlarmnetDB::openDatabase);
     }
 
     flarmnetDBDownloadable = newFlarmnetDBDownloadable;
     if (flarmnetDBDownloadable != nullptr) {
-        connect(flarmnetDBDownloadable, &DataManagement::Downloadable_Abstract::fileContentChanged, this, &Traffic::FlarmnetDB::clearCache);
-
-        // Create an empty file, if no file exists. We set the FileModificationTime
-        // to a point in the past, so that it will automatically be updated at the
-        // next convenience.
-        if (!QFile::exists(flarmnetDBDownloadable->fileName())) {
-            QFile dataFile(flarmnetDBDownloadable->fileName());
-            dataFile.open(QIODevice::WriteOnly);
-            dataFile.write(tr("Placeholder file.").toLatin1());
-            dataFile.flush();
-            dataFile.setFileTime(QDateTime( QDate(2021, 8, 21), QTime(13, 0)), QFileDevice::FileModificationTime);
-        }
-
+        connect(flarmnetDBDownloadable, &DataManagement::Downloadable_SingleFile::aboutToChangeFile, this, &Traffic::FlarmnetDB::closeDatabase);
+        connect(flarmnetDBDownloadable, &DataManagement::Downloadable_Abstract::fileContentChanged, this, &Traffic::FlarmnetDB::openDatabase);
     }
-    clearCache();
+    openDatabase();
 
 }
 
@@ -108,65 +134,193 @@ auto Traffic::FlarmnetDB::getRegistration(const QString& key) -> QString
         return *cachedValue;
     }
 
-    auto result = getRegistrationFromFile(key);
+    if (m_database == nullptr) {
+        return {};
+    }
+    auto result = m_database->lookup(key);
     m_cache.insert(key, new QString(result));
     return result;
 }
 
 
-auto Traffic::FlarmnetDB::getRegistrationFromFile(const QString& key) -> QString
+void Traffic::FlarmnetDB::onBatchFinished()
 {
+    auto results = m_batchWatcher.result();
+    auto batchDatabase = m_batchDatabase;
+    m_batchDatabase.reset();
 
-    // If not in the cache, try to find the values in the file.
+    // If the database has changed while the batch was running, the results
+    // are obsolete. Look up the keys again.
+    if (batchDatabase != m_database) {
+        if ((m_database != nullptr) || m_opening) {
+            for(auto it = results.cbegin(); it != results.cend(); ++it) {
+                m_pendingKeys.insert(it.key());
+            }
+        }
+        startBatch();
+        return;
+    }
+
+    for(auto it = results.cbegin(); it != results.cend(); ++it) {
+        m_cache.insert(it.key(), new QString(it.value()));
+        if (!it.value().isEmpty()) {
+            emit registrationFound(it.key(), it.value());
+        }
+    }
+    startBatch();
+}
+
+
+void Traffic::FlarmnetDB::openDatabase()
+{
+    closeDatabase();
     if (flarmnetDBDownloadable == nullptr) {
-        return {};
+        return;
     }
 
-    QFile dataFile(flarmnetDBDownloadable->fileName());
-    if (!dataFile.open(QIODevice::ReadOnly)) {
+    // Create an empty file, if no file exists. We set the FileModificationTime
+    // to a point in the past, so that it will automatically be updated at the
+    // next convenience.
+    if (!QFile::exists(flarmnetDBDownloadable->fileName())) {
+        QFile dataFile(flarmnetDBDownloadable->fileName());
         dataFile.open(QIODevice::WriteOnly);
         dataFile.write(tr("Placeholder file.").toLatin1());
         dataFile.flush();
         dataFile.setFileTime(QDateTime( QDate(2021, 8, 21), QTime(13, 0)), QFileDevice::FileModificationTime);
-        return {};
     }
-    dataFile.readLine();
-
-    // Now to a binary search in the file
-    qint64 lineSize   = 24;
-    qint64 firstEntry = dataFile.pos();
-    qint64 numEntries = (dataFile.size()-firstEntry)/lineSize;
-
-    auto getKey = [firstEntry, lineSize](QFile& dataFile, qint64 entry) {
-        dataFile.seek(firstEntry + entry*lineSize);
-        return QString::fromLatin1(dataFile.readLine(7));
-    };
-    auto getVal = [firstEntry, lineSize](QFile& dataFile, qint64 entry) {
-        dataFile.seek(firstEntry + entry*lineSize + 7);
-        return QString::fromLatin1(dataFile.readLine(16)).simplified();
-    };
-
-    qint64 startIndex = 0;
-    qint64 endIndex   = numEntries-1;
-    do{
-        if (getKey(dataFile, startIndex) == key) {
-            auto value = getVal(dataFile, startIndex);
-            return value;
-        }
-        if (getKey(dataFile, endIndex) == key) {
-            auto value = getVal(dataFile, endIndex);
-            return value;
+
+    // Map the file and build the index on a worker thread. Lookups are queued
+    // until the database is available.
+    m_opening = true;
+    m_openWatcher.setFuture(QtConcurrent::run([fileName = flarmnetDBDownloadable->fileName()]() {
+        auto database = std::make_shared<const Database>(fileName);
+        if (database->m_data == nullptr) {
+            return std::shared_ptr<const Database>();
         }
-        qint64 midIndex = (startIndex + endIndex)/2;
-        if (midIndex == startIndex) {
-            return {};
+        return database;
+    }));
+}
+
+
+void Traffic::FlarmnetDB::onOpenFinished()
+{
+    // Ignore the result if the database has been closed in the meantime
+    if (!m_opening) {
+        return;
+    }
+    m_opening = false;
+    m_database = m_openWatcher.result();
+    if (m_database == nullptr) {
+        m_pendingKeys.clear();
+        return;
+    }
+    startBatch();
+}
+
+
+void Traffic::FlarmnetDB::startBatch()
+{
+    if (m_batchWatcher.isRunning() || m_pendingKeys.isEmpty() || (m_database == nullptr)) {
+        return;
+    }
+
+    m_batchDatabase = m_database;
+    auto keys = m_pendingKeys.values();
+    m_pendingKeys.clear();
+    m_batchWatcher.setFuture(QtConcurrent::run([database = m_batchDatabase, keys]() {
+        QHash<QString, QString> results;
+        results.reserve(keys.size());
+        foreach(auto key, keys) {
+            results.insert(key, database->lookup(key));
         }
-        if (getKey(dataFile, midIndex) > key) {
-            endIndex = midIndex;
-        } else {
-            startIndex = midIndex;
+        return results;
+    }));
+}
+
+
+// Member functions of Traffic::FlarmnetDB::Database
+
+Traffic::FlarmnetDB::Database::Database(const QString& fileName) : m_dataFile(fileName)
+{
+    if (!m_dataFile.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    m_dataSize = m_dataFile.size();
+    if (m_dataSize > 0) {
+        m_data = m_dataFile.map(0, m_dataSize);
+    }
+    if (m_data == nullptr) {
+        m_dataSize = 0;
+        m_dataFile.close();
+        return;
+    }
+
+    // Skip header line
+    const auto* begin = reinterpret_cast<const char*>(m_data);
+    const auto* headerEnd = static_cast<const char*>(memchr(begin, '\n', m_dataSize));
+    if (headerEnd == nullptr) {
+        return;
+    }
+
+    // Each entry consists of 24 bytes: six hex digits with the Flarm ID, one
+    // separator, the registration padded with spaces, and a newline.
+    const qint64 lineSize = 24;
+    const qint64 firstEntry = headerEnd - begin + 1;
+    const qint64 numEntries = (m_dataSize-firstEntry)/lineSize;
+
+    std::vector<std::pair<quint32, quint32>> index;
+    index.reserve(numEntries);
+    for(qint64 entry=0; entry<numEntries; entry++) {
+        auto offset = firstEntry + entry*lineSize;
+        bool ok = false;
+        auto ID = QByteArray::fromRawData(begin+offset, 6).toUInt(&ok, 16);
+        if (ok) {
+            index.emplace_back(ID, static_cast<quint32>(offset));
         }
-    }while(startIndex != endIndex);
+    }
+    std::sort(index.begin(), index.end());
 
-    return {};
+    m_indexIDs.reserve(static_cast<qsizetype>(index.size()));
+    m_indexOffsets.reserve(static_cast<qsizetype>(index.size()));
+    for(const auto& [ID, offset] : index) {
+        m_indexIDs.append(ID);
+        m_indexOffsets.append(offset);
+    }
+}
+
+
+Traffic::FlarmnetDB::Database::~Database()
+{
+    if (m_data != nullptr) {
+        m_dataFile.unmap(m_data);
+    }
+}
+
+
+auto Traffic::FlarmnetDB::Database::lookup(const QString& key) const -> QString
+{
+    if ((m_data == nullptr) || (key.size() != 6)) {
+        return {};
+    }
+    bool ok = false;
+    auto ID = key.toUInt(&ok, 16);
+    if (!ok) {
+        return {};
+    }
+
+    // Binary search in the index
+    auto iterator = std::lower_bound(m_indexIDs.cbegin(), m_indexIDs.cend(), ID);
+    if ((iterator == m_indexIDs.cend()) || (*iterator != ID)) {
+        return {};
+    }
+    auto offset = m_indexOffsets[iterator - m_indexIDs.cbegin()] + 7;
+
+    // Read registration, which is at most 16 characters long
+    const auto* value = reinterpret_cast<const char*>(m_data) + offset;
+    auto length = qMin<qint64>(16, m_dataSize-offset);
+    const auto* newline = static_cast<const char*>(memchr(value, '\n', length));
+    if (newline != nullptr) {
+        length = newline - value;
+    }
+    return QString::fromLatin1(value, length).simplified();
 }
@@ -21,7 +21,11 @@
 #pragma once
 
 #include <QCache>
+#include <QFile>
+#include <QFutureWatcher>
 #include <QObject>
+#include <QSet>
+#include <memory>
 
 #include "dataManagement/Downloadable_SingleFile.h"
 
@@ -33,6 +37,17 @@ namespace Traffic {
  *  This simple class provides access to a Flarmnet database, which is in
  *  essence a glorified QHash<QString, QString>, where keys are Flarm IDs and
  *  values are aircraft registration strings.
+ *
+ *  The database file is memory-mapped. Whenever the file changes, the class
+ *  builds a compact index of 24-bit Flarm IDs and file offsets, sorted by
+ *  ID, on a worker thread, so that lookups are binary searches in memory that
+ *  do not require any system calls.  Results of lookups are kept in a cache of
+ *  bounded size, which evicts the least recently used entries.
+ *
+ *  Code that must not block, such as the traffic data parsers, should use
+ *  cachedRegistration(). This method never touches the database file. Cache
+ *  misses are queued and resolved in batches on a worker thread, and the
+ *  signal registrationFound() is emitted once the result is known.
  */
 class FlarmnetDB : public QObject {
     Q_OBJECT
@@ -48,6 +63,9 @@ public:
 
     ~FlarmnetDB() override = default;
 
+    /*! \brief Maximal number of entries in the cache */
+    static constexpr int maxCacheSize = 1000;
+
     //
     // Methods
     //
@@ -61,9 +79,40 @@ public:
      */
     Q_INVOKABLE QString getRegistration(const QString& key);
 
+    /*! \brief Find registration for a given key, without blocking
+     *
+     *  If the result of the lookup is in the cache, this method returns it.
+     *  Otherwise, the key is queued for lookup on a worker thread, and the
+     *  method returns an empty string immediately.  Once the lookup is done,
+     *  the result is added to the cache and, if the database contains the key,
+     *  the signal registrationFound() is emitted.
+     *
+     *  @param key FlarmID to look up
+     *
+     *  @returns Aircraft registration, or an empty string if the database does
+     *  not contain the key or if the key is not yet in the cache
+     */
+    auto cachedRegistration(const QString& key) -> QString;
+
+signals:
+    /*! \brief Asynchronous lookup finished
+     *
+     *  This signal is emitted when a lookup requested by cachedRegistration()
+     *  has found a registration.
+     *
+     *  @param key FlarmID that was looked up
+     *
+     *  @param registration Aircraft registration
+     */
+    void registrationFound(const QString& key, const QString& registration);
+
 private slots:
-    // The title says everything
-    void clearCache();
+    // Unmaps the database file and clears index and cache
+    void closeDatabase();
+
+    // Starts mapping the database file into memory and building the index on
+    // a worker thread. Creates a placeholder file if no database file exists.
+    void openDatabase();
 
     // The title says everything
     void deferredInitialization();
@@ -71,12 +120,63 @@ private slots:
     // The title says everything
     void findFlarmnetDBDownloadable();
 
+    // Called when the worker thread has finished a batch of lookups. Adds the
+    // results to the cache and starts the next batch, if any.
+    void onBatchFinished();
+
+    // Called when the worker thread has opened the database. Makes the
+    // database available and starts looking up the pending keys.
+    void onOpenFinished();
+
 private:
-    auto getRegistrationFromFile(const QString& key) -> QString;
+    // Memory-mapped database file, together with its index. Once constructed,
+    // instances are never modified and can be read from any thread. The file
+    // is unmapped when the last reference to the instance is dropped.
+    class Database
+    {
+    public:
+        explicit Database(const QString& fileName);
+        ~Database();
+        Q_DISABLE_COPY_MOVE(Database)
+
+        // Look up key. Returns an empty string if the key is not found.
+        [[nodiscard]] auto lookup(const QString& key) const -> QString;
+
+        QFile m_dataFile;
+        uchar* m_data {nullptr};
+        qint64 m_dataSize {0};
+
+        // Index into m_data. The list m_indexIDs contains the Flarm IDs found
+        // in the database in ascending order. For every i, the entry for the
+        // Flarm ID m_indexIDs[i] starts at offset m_indexOffsets[i] in the
+        // database file.
+        QVector<quint32> m_indexIDs;
+        QVector<quint32> m_indexOffsets;
+    };
+
+    // Start lookup of all pending keys on a worker thread, unless a batch is
+    // already running
+    void startBatch();
 
     QPointer<DataManagement::Downloadable_SingleFile> flarmnetDBDownloadable;
 
-    QCache<QString, QString> m_cache {};
+    QCache<QString, QString> m_cache {maxCacheSize};
+
+    // Current database, or nullptr if no database is available
+    std::shared_ptr<const Database> m_database;
+
+    // Opening of the database on a worker thread. The flag m_opening is set
+    // while the result of m_openWatcher is expected to become the current
+    // database.
+    QFutureWatcher<std::shared_ptr<const Database>> m_openWatcher;
+    bool m_opening {false};
+
+    // Asynchronous lookups. Keys in m_pendingKeys wait for the next batch.
+    // While a batch is running, m_batchDatabase holds the database that the
+    // worker thread uses.
+    QSet<QString> m_pendingKeys;
+    QFutureWatcher<QHash<QString, QString>> m_batchWatcher;
+    std::shared_ptr<const Database> m_batchDatabase;
 };
 
 } // namespace Traffic
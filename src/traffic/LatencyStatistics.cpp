@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "traffic/LatencyStatistics.h"
+
+
+// Static Helper functions
+
+// Names of paths and stages, as used in the report
+const std::array<const char*, 2> pathNames {"Warning", "Factor"};
+const std::array<const char*, 4> stageNames {"decoded", "provider updated", "property changed", "displayed"};
+
+
+// Member functions
+
+void Traffic::LatencyStatistics::clear()
+{
+    m_histograms = {};
+    m_warningsOverBudget = 0;
+}
+
+
+auto Traffic::LatencyStatistics::record(Path path, Stage stage, qint64 received, qint64 reached) -> qint64
+{
+    if (received < 0) {
+        return -1;
+    }
+    auto latencyNS = qMax(reached-received, static_cast<qint64>(0));
+
+    auto& histogram = m_histograms[path*numStages + stage];
+    qsizetype bucket = 0;
+    while ((bucket < static_cast<qsizetype>(bucketBoundsMS.size())) && (latencyNS >= bucketBoundsMS[bucket]*1000000)) {
+        bucket++;
+    }
+    histogram.counts[bucket]++;
+    histogram.total++;
+    histogram.sumNS += latencyNS;
+    histogram.maxNS = qMax(histogram.maxNS, latencyNS);
+
+    if ((path == Warning) && (stage == Displayed) && (latencyNS > std::chrono::nanoseconds(warningBudget).count())) {
+        m_warningsOverBudget++;
+    }
+    return latencyNS;
+}
+
+
+auto Traffic::LatencyStatistics::report() const -> QString
+{
+    QString result;
+    for(int path=0; path<numPaths; path++) {
+        for(int stage=0; stage<numStages; stage++) {
+            const auto& histogram = m_histograms[path*numStages + stage];
+            if (histogram.total == 0) {
+                continue;
+            }
+            result += QStringLiteral("%1 %2: n=%3, mean=%4 ms, max=%5 ms\n")
+                    .arg(pathNames[path], stageNames[stage])
+                    .arg(histogram.total)
+                    .arg(static_cast<double>(histogram.sumNS)/static_cast<double>(histogram.total)/1e6, 0, 'f', 2)
+                    .arg(static_cast<double>(histogram.maxNS)/1e6, 0, 'f', 2);
+            for(qsizetype bucket=0; bucket<static_cast<qsizetype>(histogram.counts.size()); bucket++) {
+                if (histogram.counts[bucket] == 0) {
+                    continue;
+                }
+                if (bucket < static_cast<qsizetype>(bucketBoundsMS.size())) {
+                    result += QStringLiteral("  < %1 ms: %2\n").arg(bucketBoundsMS[bucket]).arg(histogram.counts[bucket]);
+                } else {
+                    result += QStringLiteral("  >= %1 ms: %2\n").arg(bucketBoundsMS.back()).arg(histogram.counts[bucket]);
+                }
+            }
+        }
+    }
+    result += QStringLiteral("Warnings displayed later than %1 ms: %2\n")
+            .arg(std::chrono::milliseconds(warningBudget).count())
+            .arg(m_warningsOverBudget);
+    return result;
+}
@@ -0,0 +1,144 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <array>
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+
+namespace Traffic {
+
+/*! \brief Latency histograms for the traffic data path
+ *
+ *  This class collects statistics on the time that traffic data needs from
+ *  the moment it is read from a socket to the moment it becomes visible on
+ *  screen.  All times are taken from a monotonic clock, see now().  For every
+ *  path (traffic warnings and traffic factors) and every stage, the class
+ *  keeps a histogram of the time elapsed since the data was received.
+ *
+ *  Histograms have a fixed number of buckets, so that recording is cheap and
+ *  does not allocate memory.
+ */
+class LatencyStatistics {
+
+public:
+    /*! \brief Path that data takes through the application */
+    enum Path
+    {
+        Warning = 0, /*!< Traffic warnings, such as PFLAU sentences */
+        Factor = 1,  /*!< Traffic factors, such as PFLAA sentences */
+    };
+
+    /*! \brief Stage of the traffic data path */
+    enum Stage
+    {
+        Decoded = 0,         /*!< The data source has decoded the data */
+        ProviderUpdated = 1, /*!< The TrafficDataProvider has received the data */
+        PropertyChanged = 2, /*!< Notifier signals of the properties seen by QML have returned */
+        Displayed = 3,       /*!< The next frame has been swapped to screen */
+    };
+
+    /*! \brief Time stamps of the data currently processed by a data source
+     *
+     *  Time stamps are in nanoseconds, as returned by now(). Negative values
+     *  mean that the time stamp is not known.
+     */
+    struct Stamps
+    {
+        qint64 received {-1};
+        qint64 decoded {-1};
+    };
+
+    /*! \brief Latency budget for traffic warnings
+     *
+     *  Traffic warnings that are not displayed within this time are counted
+     *  and reported.
+     */
+    static constexpr auto warningBudget = 250ms;
+
+    /*! \brief Current time of the monotonic clock
+     *
+     *  @returns Current time in nanoseconds, relative to an unspecified epoch
+     */
+    [[nodiscard]] static auto now() -> qint64
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /*! \brief Record latency
+     *
+     *  @param path Path of the data
+     *
+     *  @param stage Stage that the data has reached
+     *
+     *  @param received Time at which the data was received, as returned by
+     *  now(). If negative, this method does nothing.
+     *
+     *  @param reached Time at which the data has reached the stage, as returned
+     *  by now()
+     *
+     *  @returns Latency in nanoseconds, or -1 if nothing was recorded
+     */
+    auto record(Path path, Stage stage, qint64 received, qint64 reached = now()) -> qint64;
+
+    /*! \brief Number of traffic warnings that were displayed too late
+     *
+     *  @returns Number of traffic warnings whose latency at stage Displayed
+     *  exceeded warningBudget
+     */
+    [[nodiscard]] auto warningsOverBudget() const -> qint64
+    {
+        return m_warningsOverBudget;
+    }
+
+    /*! \brief Human-readable summary of all histograms
+     *
+     *  @returns Multi-line string, suitable for log output or for display on
+     *  a debug page.  Histograms without data are omitted.
+     */
+    [[nodiscard]] auto report() const -> QString;
+
+    /*! \brief Remove all data */
+    void clear();
+
+private:
+    // Upper bounds of the histogram buckets, in milliseconds. The last bucket
+    // collects everything above the last bound.
+    static constexpr std::array<qint64, 10> bucketBoundsMS {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+    static constexpr int numPaths = 2;
+    static constexpr int numStages = 4;
+
+    struct Histogram
+    {
+        std::array<qint64, bucketBoundsMS.size()+1> counts {};
+        qint64 total {0};
+        qint64 sumNS {0};
+        qint64 maxNS {0};
+    };
+
+    std::array<Histogram, numPaths*numStages> m_histograms {};
+    qint64 m_warningsOverBudget {0};
+};
+
+} // namespace Traffic
@@ -0,0 +1,205 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <QDateTime>
+#include <QtMath>
+#include <limits>
+
+#include "positioning/LocalTangentPlane.h"
+#include "traffic/TrackHistory.h"
+
+
+// Static Helper functions
+
+// Segments shorter than this are not used to estimate the turn rate, because
+// their azimuth is dominated by position noise
+const double minSegmentLengthInM = 30.0;
+
+
+// Member functions
+
+Traffic::TrackHistory::TrackHistory()
+    : m_arena(maxTracks*pointsPerTrack)
+{
+    m_trackIndex.reserve(maxTracks);
+}
+
+
+void Traffic::TrackHistory::append(const QString& ID, const QGeoPositionInfo& info)
+{
+    auto coordinate = info.coordinate();
+    if (!coordinate.isValid()) {
+        return;
+    }
+    auto time = info.timestamp().isValid() ? info.timestamp().toMSecsSinceEpoch() : QDateTime::currentMSecsSinceEpoch();
+
+    // Find track. If the target is new, take an unused track, or recycle the
+    // track that has not been updated for the longest time.
+    auto trackIndex = m_trackIndex.value(ID, -1);
+    if (trackIndex < 0) {
+        qint64 oldestTime = std::numeric_limits<qint64>::max();
+        for(qsizetype i=0; i<maxTracks; i++) {
+            if (m_tracks[i].size == 0) {
+                trackIndex = i;
+                break;
+            }
+            auto lastTime = point(i, m_tracks[i].size-1).time;
+            if (lastTime < oldestTime) {
+                oldestTime = lastTime;
+                trackIndex = i;
+            }
+        }
+        if (m_tracks[trackIndex].size != 0) {
+            m_trackIndex.remove(m_tracks[trackIndex].ID);
+        }
+        m_tracks[trackIndex] = {ID, 0, 0};
+        m_trackIndex.insert(ID, trackIndex);
+    }
+
+    // Do not record positions that arrive too often, or out of order
+    auto& track = m_tracks[trackIndex];
+    if ((track.size > 0) && (time < point(trackIndex, track.size-1).time + minInterval)) {
+        return;
+    }
+
+    // Write point, overwriting the oldest point if the ring buffer is full
+    auto slot = (track.first+track.size) % pointsPerTrack;
+    if (track.size < pointsPerTrack) {
+        track.size++;
+    } else {
+        track.first = (track.first+1) % pointsPerTrack;
+    }
+    auto altitude = (coordinate.type() == QGeoCoordinate::Coordinate3D) ? coordinate.altitude() : qQNaN();
+    m_arena[trackIndex*pointsPerTrack + slot] = {coordinate.latitude(), coordinate.longitude(), altitude, time};
+}
+
+
+void Traffic::TrackHistory::clear()
+{
+    for(auto& track : m_tracks) {
+        track = {};
+    }
+    m_trackIndex.clear();
+}
+
+
+auto Traffic::TrackHistory::climbRate(const QString& ID) const -> Units::Speed
+{
+    auto trackIndex = m_trackIndex.value(ID, -1);
+    if (trackIndex < 0) {
+        return {};
+    }
+    const auto& track = m_tracks[trackIndex];
+
+    // Oldest and newest point with altitude within the estimation window
+    const Point* first = nullptr;
+    const Point* last = nullptr;
+    for(auto i=firstPointWithin(trackIndex, estimationWindow); i<track.size; i++) {
+        const auto& p = point(trackIndex, i);
+        if (!qIsFinite(p.altitude)) {
+            continue;
+        }
+        if (first == nullptr) {
+            first = &p;
+        }
+        last = &p;
+    }
+    if ((first == nullptr) || (last->time - first->time < 2*minInterval)) {
+        return {};
+    }
+    return Units::Speed::fromMPS(1000.0*(last->altitude - first->altitude)/static_cast<double>(last->time - first->time));
+}
+
+
+auto Traffic::TrackHistory::firstPointWithin(qsizetype trackIndex, qint64 age) const -> qsizetype
+{
+    const auto& track = m_tracks[trackIndex];
+    if (track.size == 0) {
+        return 0;
+    }
+    auto newestTime = point(trackIndex, track.size-1).time;
+    qsizetype i = 0;
+    while ((i < track.size-1) && (point(trackIndex, i).time < newestTime-age)) {
+        i++;
+    }
+    return i;
+}
+
+
+auto Traffic::TrackHistory::trail(const QString& ID) const -> QList<QGeoCoordinate>
+{
+    auto trackIndex = m_trackIndex.value(ID, -1);
+    if (trackIndex < 0) {
+        return {};
+    }
+    const auto& track = m_tracks[trackIndex];
+
+    QList<QGeoCoordinate> result;
+    auto i = firstPointWithin(trackIndex, maxAge);
+    result.reserve(track.size-i);
+    for(; i<track.size; i++) {
+        const auto& p = point(trackIndex, i);
+        result.append(QGeoCoordinate(p.latitude, p.longitude));
+    }
+    return result;
+}
+
+
+auto Traffic::TrackHistory::turnRate(const QString& ID) const -> double
+{
+    auto trackIndex = m_trackIndex.value(ID, -1);
+    if (trackIndex < 0) {
+        return qQNaN();
+    }
+    const auto& track = m_tracks[trackIndex];
+
+    // Split the points within the estimation window into two segments, and
+    // compare their azimuths
+    auto firstIndex = firstPointWithin(trackIndex, estimationWindow);
+    auto lastIndex = track.size-1;
+    if (lastIndex-firstIndex < 2) {
+        return qQNaN();
+    }
+    auto midIndex = (firstIndex+lastIndex)/2;
+    const auto& first = point(trackIndex, firstIndex);
+    const auto& mid = point(trackIndex, midIndex);
+    const auto& last = point(trackIndex, lastIndex);
+
+    Positioning::LocalTangentPlane plane(QGeoCoordinate(mid.latitude, mid.longitude));
+    auto firstENU = plane.toENU(QGeoCoordinate(first.latitude, first.longitude));
+    auto lastENU = plane.toENU(QGeoCoordinate(last.latitude, last.longitude));
+    Positioning::LocalTangentPlane::ENU midENU;
+    if ((Positioning::LocalTangentPlane::hDist(firstENU, midENU).toM() < minSegmentLengthInM)
+        || (Positioning::LocalTangentPlane::hDist(midENU, lastENU).toM() < minSegmentLengthInM)) {
+        return qQNaN();
+    }
+
+    auto change = Positioning::LocalTangentPlane::azimuth(midENU, lastENU).toDEG() - Positioning::LocalTangentPlane::azimuth(firstENU, midENU).toDEG();
+    while (change > 180.0) {
+        change -= 360.0;
+    }
+    while (change < -180.0) {
+        change += 360.0;
+    }
+
+    // The azimuths describe the track at the midpoints of the two segments
+    auto seconds = static_cast<double>(last.time - first.time)/2000.0;
+    return change/seconds;
+}
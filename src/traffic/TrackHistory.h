@@ -0,0 +1,150 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QGeoPositionInfo>
+#include <QHash>
+#include <array>
+#include <vector>
+
+#include "units/Speed.h"
+
+
+namespace Traffic {
+
+/*! \brief Recent positions of traffic targets
+ *
+ *  This class keeps, for every traffic target, a short history of recent
+ *  positions in a ring buffer.  The history is used to draw trails, and to
+ *  estimate climb rate and turn rate of targets whose traffic receiver does
+ *  not report them.
+ *
+ *  All ring buffers live in one arena that is allocated once, in the
+ *  constructor.  The class holds at most maxTracks targets; if a new target
+ *  appears while all tracks are in use, the track that has not been updated
+ *  for the longest time is recycled.  The memory used is therefore bounded,
+ *  regardless of the number of targets seen.
+ */
+class TrackHistory {
+
+public:
+    /*! \brief Maximal number of targets */
+    static constexpr qsizetype maxTracks = 64;
+
+    /*! \brief Maximal number of positions per target */
+    static constexpr qsizetype pointsPerTrack = 32;
+
+    /*! \brief Minimal time between two positions, in milliseconds
+     *
+     *  Positions that are reported more often are not recorded.
+     */
+    static constexpr qint64 minInterval = 900;
+
+    /*! \brief Maximal age of positions, in milliseconds
+     *
+     *  Older positions are ignored.
+     */
+    static constexpr qint64 maxAge = 30000;
+
+    /*! \brief Constructs an empty history */
+    TrackHistory();
+
+    /*! \brief Record position of target
+     *
+     *  @param ID Target ID
+     *
+     *  @param info Position info of the target. If the position info has a
+     *  valid time stamp, it is used as the time of the position. Otherwise, the
+     *  current time is used.  Invalid coordinates are ignored.
+     */
+    void append(const QString& ID, const QGeoPositionInfo& info);
+
+    /*! \brief Remove all tracks */
+    void clear();
+
+    /*! \brief Estimated climb rate
+     *
+     *  @param ID Target ID
+     *
+     *  @returns Climb rate, computed from the altitudes recorded within the
+     *  last estimationWindow.  Invalid if the target is unknown, or if not
+     *  enough positions with altitude are recorded.
+     */
+    [[nodiscard]] auto climbRate(const QString& ID) const -> Units::Speed;
+
+    /*! \brief Recorded positions
+     *
+     *  @param ID Target ID
+     *
+     *  @returns Positions of the target that are not older than maxAge,
+     *  oldest first.  Empty if the target is unknown.
+     */
+    [[nodiscard]] auto trail(const QString& ID) const -> QList<QGeoCoordinate>;
+
+    /*! \brief Estimated turn rate
+     *
+     *  @param ID Target ID
+     *
+     *  @returns Turn rate in degrees per second, positive values for right
+     *  turns, computed from the change of track within the last
+     *  estimationWindow.  NaN if the target is unknown, if not enough positions
+     *  are recorded, or if the target hardly moves.
+     */
+    [[nodiscard]] auto turnRate(const QString& ID) const -> double;
+
+private:
+    // Time window used to estimate climb and turn rates, in milliseconds
+    static constexpr qint64 estimationWindow = 10000;
+
+    struct Point
+    {
+        double latitude;
+        double longitude;
+        double altitude;
+        qint64 time;
+    };
+
+    struct Track
+    {
+        QString ID;
+
+        // Index of the oldest point, relative to the start of the track in the
+        // arena, and number of points
+        qsizetype first {0};
+        qsizetype size {0};
+    };
+
+    // Returns the i-th point of track number trackIndex, oldest first
+    [[nodiscard]] auto point(qsizetype trackIndex, qsizetype i) const -> const Point&
+    {
+        return m_arena[trackIndex*pointsPerTrack + (m_tracks[trackIndex].first+i) % pointsPerTrack];
+    }
+
+    // Returns the index of the first point of the track that is not older
+    // than the given age, relative to the newest point
+    [[nodiscard]] auto firstPointWithin(qsizetype trackIndex, qint64 age) const -> qsizetype;
+
+    std::vector<Point> m_arena;
+    std::array<Track, maxTracks> m_tracks;
+    QHash<QString, qsizetype> m_trackIndex;
+};
+
+} // namespace Traffic
@@ -0,0 +1,297 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <QDebug>
+#include <QtEndian>
+#include <chrono>
+#include <cstring>
+
+#include "traffic/TrafficCapture.h"
+
+
+// Static Helper functions
+
+// Layout of the file header
+const char captureMagic[8] = {'E', 'N', 'R', 'T', 'C', 'A', 'P', '\0'};
+const quint32 captureVersion = 1;
+const qint64 offsetVersion = 8;
+const qint64 offsetCapacity = 16;
+const qint64 offsetHead = 24;
+const qint64 offsetTail = 32;
+const qint64 offsetNumRecords = 40;
+
+// Value of the length field that marks the end of the used part of the ring
+// buffer. The next record is found at the beginning of the ring buffer.
+const quint32 wrapMarker = 0xFFFFFFFF;
+
+// Records are aligned to multiples of eight bytes
+auto paddedRecordSize(qint64 payloadSize) -> qint64
+{
+    return (Traffic::TrafficCapture::recordHeaderSize + payloadSize + 7) & ~static_cast<qint64>(7);
+}
+
+// Checks if the header found at data is a valid capture file header, for a
+// file of the given size
+auto isValidHeader(const uchar* data, qint64 fileSize) -> bool
+{
+    if (fileSize < Traffic::TrafficCapture::headerSize) {
+        return false;
+    }
+    if (memcmp(data, captureMagic, sizeof(captureMagic)) != 0) {
+        return false;
+    }
+    if (qFromLittleEndian<quint32>(data+offsetVersion) != captureVersion) {
+        return false;
+    }
+    auto capacity = qFromLittleEndian<qint64>(data+offsetCapacity);
+    auto head = qFromLittleEndian<qint64>(data+offsetHead);
+    auto tail = qFromLittleEndian<qint64>(data+offsetTail);
+    return (capacity == fileSize-Traffic::TrafficCapture::headerSize)
+            && (head >= 0) && (head <= capacity)
+            && (tail >= 0) && (tail <= capacity)
+            && (qFromLittleEndian<qint64>(data+offsetNumRecords) >= 0);
+}
+
+// Offset of the record that follows the record at offset in a ring buffer of
+// the given capacity. If the record at offset is a wrap marker, or if there is
+// no room for a record at offset, this is the start of the ring buffer.
+auto nextRecord(const uchar* ringBuffer, qint64 capacity, qint64 offset) -> qint64
+{
+    if ((capacity-offset < Traffic::TrafficCapture::recordHeaderSize)
+        || (qFromLittleEndian<quint32>(ringBuffer+offset) == wrapMarker)) {
+        return 0;
+    }
+    return offset + paddedRecordSize(qFromLittleEndian<quint32>(ringBuffer+offset));
+}
+
+
+// Member functions
+
+Traffic::TrafficCapture::TrafficCapture(const QString& fileName, qint64 capacity, QObject* parent)
+    : QObject(parent), m_file(fileName)
+{
+    capacity = capacity & ~static_cast<qint64>(7);
+    if (capacity < 1024) {
+        qWarning() << "TrafficCapture: capacity too small" << capacity;
+        return;
+    }
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qWarning() << "TrafficCapture: cannot open" << fileName << m_file.errorString();
+        return;
+    }
+
+    // Check if we can continue an existing capture
+    bool resume = false;
+    if (m_file.size() == headerSize+capacity) {
+        auto header = m_file.read(headerSize);
+        resume = (header.size() == headerSize) && isValidHeader(reinterpret_cast<const uchar*>(header.constData()), m_file.size());
+    }
+
+    // Preallocate file
+    if (!resume && !m_file.resize(headerSize+capacity)) {
+        qWarning() << "TrafficCapture: cannot resize" << fileName << m_file.errorString();
+        m_file.close();
+        return;
+    }
+
+    m_data = m_file.map(0, headerSize+capacity);
+    if (m_data == nullptr) {
+        qWarning() << "TrafficCapture: cannot map" << fileName << m_file.errorString();
+        m_file.close();
+        return;
+    }
+    m_capacity = capacity;
+
+    if (resume) {
+        m_head = qFromLittleEndian<qint64>(m_data+offsetHead);
+        m_tail = qFromLittleEndian<qint64>(m_data+offsetTail);
+        m_numRecords = qFromLittleEndian<qint64>(m_data+offsetNumRecords);
+    } else {
+        memset(m_data, 0, headerSize);
+        memcpy(m_data, captureMagic, sizeof(captureMagic));
+        qToLittleEndian<quint32>(captureVersion, m_data+offsetVersion);
+        qToLittleEndian<qint64>(m_capacity, m_data+offsetCapacity);
+        writeHeader();
+    }
+}
+
+
+Traffic::TrafficCapture::~TrafficCapture()
+{
+    if (m_data != nullptr) {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+    m_file.close();
+}
+
+
+void Traffic::TrafficCapture::dropOldestRecord()
+{
+    if (m_numRecords == 0) {
+        m_tail = m_head;
+        return;
+    }
+
+    // If the tail points to a wrap marker, move to the start of the ring buffer
+    // first. Wrap markers are not counted as records.
+    auto* ringBuffer = m_data+headerSize;
+    if ((m_capacity-m_tail < recordHeaderSize) || (qFromLittleEndian<quint32>(ringBuffer+m_tail) == wrapMarker)) {
+        m_tail = 0;
+        return;
+    }
+    m_tail = nextRecord(ringBuffer, m_capacity, m_tail);
+    m_numRecords--;
+    if (m_numRecords == 0) {
+        m_tail = m_head;
+    }
+}
+
+
+auto Traffic::TrafficCapture::isCaptureFile(const QString& fileName) -> bool
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    auto header = file.read(headerSize);
+    if (header.size() != headerSize) {
+        return false;
+    }
+    return isValidHeader(reinterpret_cast<const uchar*>(header.constData()), file.size());
+}
+
+
+auto Traffic::TrafficCapture::readRecords(const QString& fileName) -> QVector<Traffic::TrafficCapture::Record>
+{
+    QVector<Traffic::TrafficCapture::Record> result;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    auto fileSize = file.size();
+    if (fileSize < headerSize) {
+        return {};
+    }
+    auto* data = file.map(0, fileSize);
+    if (data == nullptr) {
+        return {};
+    }
+    if (!isValidHeader(data, fileSize)) {
+        file.unmap(data);
+        return {};
+    }
+
+    auto capacity = qFromLittleEndian<qint64>(data+offsetCapacity);
+    auto tail = qFromLittleEndian<qint64>(data+offsetTail);
+    auto numRecords = qFromLittleEndian<qint64>(data+offsetNumRecords);
+    const auto* ringBuffer = data+headerSize;
+
+    result.reserve(numRecords);
+    auto offset = tail;
+    while(result.size() < numRecords) {
+        if ((capacity-offset < recordHeaderSize) || (qFromLittleEndian<quint32>(ringBuffer+offset) == wrapMarker)) {
+            if (offset == 0) {
+                // Corrupt file: wrap marker at the start of the buffer
+                break;
+            }
+            offset = 0;
+            continue;
+        }
+
+        auto length = qFromLittleEndian<quint32>(ringBuffer+offset);
+        if (offset + recordHeaderSize + length > capacity) {
+            qWarning() << "TrafficCapture: corrupt record in" << fileName;
+            break;
+        }
+
+        Record record;
+        record.transport = static_cast<Transport>(ringBuffer[offset+4]);
+        record.port = qFromLittleEndian<quint16>(ringBuffer+offset+6);
+        record.timeStamp = qFromLittleEndian<qint64>(ringBuffer+offset+8);
+        record.data = QByteArray(reinterpret_cast<const char*>(ringBuffer+offset+recordHeaderSize), length);
+        result.append(record);
+
+        offset = nextRecord(ringBuffer, capacity, offset);
+    }
+
+    file.unmap(data);
+    return result;
+}
+
+
+void Traffic::TrafficCapture::write(Traffic::TrafficCapture::Transport transport, quint16 port, QByteArrayView data)
+{
+    if (m_data == nullptr) {
+        return;
+    }
+    auto recordSize = paddedRecordSize(data.size());
+    if (recordSize > m_capacity/2) {
+        return;
+    }
+
+    auto timeStamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    auto* ringBuffer = m_data+headerSize;
+
+    // If the record does not fit between head and end of the ring buffer, drop
+    // all records stored there, mark the end of the used part and continue at
+    // the start of the ring buffer.
+    if (m_head + recordSize > m_capacity) {
+        while ((m_numRecords > 0) && (m_tail >= m_head)) {
+            dropOldestRecord();
+        }
+        if (m_capacity-m_head >= recordHeaderSize) {
+            qToLittleEndian<quint32>(wrapMarker, ringBuffer+m_head);
+        }
+        m_head = 0;
+        if (m_numRecords == 0) {
+            m_tail = 0;
+        }
+    }
+
+    // Drop all records that would be overwritten
+    while ((m_numRecords > 0) && (m_tail >= m_head) && (m_tail < m_head+recordSize)) {
+        dropOldestRecord();
+    }
+
+    // Write record
+    qToLittleEndian<quint32>(static_cast<quint32>(data.size()), ringBuffer+m_head);
+    ringBuffer[m_head+4] = transport;
+    ringBuffer[m_head+5] = 0;
+    qToLittleEndian<quint16>(port, ringBuffer+m_head+6);
+    qToLittleEndian<qint64>(timeStamp, ringBuffer+m_head+8);
+    memcpy(ringBuffer+m_head+recordHeaderSize, data.constData(), data.size());
+
+    if (m_numRecords == 0) {
+        m_tail = m_head;
+    }
+    m_head += recordSize;
+    m_numRecords++;
+    writeHeader();
+}
+
+
+void Traffic::TrafficCapture::writeHeader()
+{
+    qToLittleEndian<qint64>(m_head, m_data+offsetHead);
+    qToLittleEndian<qint64>(m_tail, m_data+offsetTail);
+    qToLittleEndian<qint64>(m_numRecords, m_data+offsetNumRecords);
+}
@@ -0,0 +1,166 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QByteArrayView>
+#include <QFile>
+#include <QObject>
+#include <QVector>
+
+
+namespace Traffic {
+
+/*! \brief Raw traffic data capture
+ *
+ *  This class records raw data received from traffic receivers, together with
+ *  time stamps in microseconds and a tag describing the source (transport and
+ *  port).  The data is written to a file of fixed size that is memory-mapped
+ *  and used as a ring buffer: once the file is full, the oldest records are
+ *  overwritten.  Writing a record is a memcpy into the mapped file and never
+ *  blocks on file I/O, so that recording can be done directly from the socket
+ *  handlers.
+ *
+ *  The file starts with a header of headerSize bytes, containing a magic
+ *  string, the format version, the capacity of the ring buffer, the offsets of
+ *  the oldest record and of the next record to be written, and the number of
+ *  records.  Each record consists of a header of recordHeaderSize bytes
+ *  (payload length, transport, port and time stamp), followed by the payload,
+ *  padded to a multiple of eight bytes.  All numbers are little endian.
+ *
+ *  Capture files can be replayed with TrafficDataSource_File.
+ */
+class TrafficCapture : public QObject {
+    Q_OBJECT
+
+public:
+    /*! \brief Transport over which data was received */
+    enum Transport : quint8
+    {
+        TCP = 1, /*!< Data was received via TCP */
+        UDP = 2  /*!< Data was received as a UDP datagram */
+    };
+
+    /*! \brief Single record in a capture file */
+    struct Record
+    {
+        /*! \brief Time of reception, in microseconds since the epoch */
+        qint64 timeStamp {0};
+
+        /*! \brief Transport over which data was received */
+        Transport transport {TCP};
+
+        /*! \brief Port on which data was received */
+        quint16 port {0};
+
+        /*! \brief Raw data, exactly as received */
+        QByteArray data;
+    };
+
+    /*! \brief Default constructor
+     *
+     *  Opens the capture file and maps it into memory. If the file exists and
+     *  is a capture file of the given capacity, new records are appended.
+     *  Otherwise, the file is created or overwritten. Use isValid() to check
+     *  if the file could be opened.
+     *
+     *  @param fileName Name of the capture file
+     *
+     *  @param capacity Size of the ring buffer in bytes, not including the file
+     *  header
+     *
+     *  @param parent The standard QObject parent pointer
+     */
+    explicit TrafficCapture(const QString& fileName, qint64 capacity = defaultCapacity, QObject* parent = nullptr);
+
+    // Standard destructor
+    ~TrafficCapture() override;
+
+    /*! \brief Default capacity of the ring buffer, in bytes */
+    static constexpr qint64 defaultCapacity = 64*1024*1024;
+
+    /*! \brief Size of the file header, in bytes */
+    static constexpr qint64 headerSize = 64;
+
+    /*! \brief Size of the record header, in bytes */
+    static constexpr qint64 recordHeaderSize = 16;
+
+    /*! \brief Checks if a file is a capture file
+     *
+     *  @param fileName Name of the file to be checked
+     *
+     *  @returns True if the file begins with a valid capture file header
+     */
+    static auto isCaptureFile(const QString& fileName) -> bool;
+
+    /*! \brief Checks if the capture file is open and mapped
+     *
+     *  @returns True if records can be written
+     */
+    [[nodiscard]] auto isValid() const -> bool
+    {
+        return m_data != nullptr;
+    }
+
+    /*! \brief Reads all records from a capture file
+     *
+     *  @param fileName Name of the capture file
+     *
+     *  @returns Records found in the file, oldest record first. The list is
+     *  empty if the file cannot be read or is not a capture file.
+     */
+    static auto readRecords(const QString& fileName) -> QVector<Traffic::TrafficCapture::Record>;
+
+    /*! \brief Write record
+     *
+     *  Writes data to the capture file, with the current time as a time stamp.
+     *  If necessary, the oldest records are dropped to make room. Data that
+     *  does not fit into half of the ring buffer is silently ignored.
+     *
+     *  @param transport Transport over which data was received
+     *
+     *  @param port Port on which data was received
+     *
+     *  @param data Raw data, exactly as received
+     */
+    void write(Traffic::TrafficCapture::Transport transport, quint16 port, QByteArrayView data);
+
+private:
+    Q_DISABLE_COPY_MOVE(TrafficCapture)
+
+    // Drop the oldest record
+    void dropOldestRecord();
+
+    // Write header fields head, tail and number of records to the file header
+    void writeHeader();
+
+    QFile m_file;
+    uchar* m_data {nullptr};
+
+    // Capacity of the ring buffer. Offsets m_head and m_tail are relative to
+    // the start of the ring buffer. New records are written at m_head, the
+    // oldest record is found at m_tail.
+    qint64 m_capacity {0};
+    qint64 m_head {0};
+    qint64 m_tail {0};
+    qint64 m_numRecords {0};
+};
+
+} // namespace Traffic
@@ -19,11 +19,14 @@
  ***************************************************************************/
 
 #include <QCoreApplication>
+#include <QDebug>
 #include <QQmlEngine>
 #include <chrono>
 
 #include "GlobalObject.h"
 #include "platform/PlatformAdaptor_Abstract.h"
+#include "positioning/PositionProvider.h"
+#include "traffic/FlarmnetDB.h"
 #include "traffic/TrafficDataProvider.h"
 #include "traffic/TrafficDataSource_Tcp.h"
 #include "traffic/TrafficDataSource_Udp.h"
@@ -47,6 +50,12 @@ Traffic::TrafficDataProvider::TrafficDataProvider(QObject *parent) : Positioning
     m_trafficObjectWithoutPosition = new Traffic::TrafficFactor_DistanceOnly(this);
     QQmlEngine::setObjectOwnership(m_trafficObjectWithoutPosition, QQmlEngine::CppOwnership);
 
+    // Setup timing wheel for the lifetimes of traffic objects. The timer runs
+    // only while there are traffic objects whose lifetime has not expired.
+    m_lifeTimeWheelTimer.setInterval(lifeTimeWheelInterval);
+    m_lifeTimeWheelTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_lifeTimeWheelTimer, &QTimer::timeout, this, &Traffic::TrafficDataProvider::onLifeTimeWheelTick);
+
     setSourceName(tr("Traffic data receiver"));
 
     // Setup FLARM warning
@@ -70,6 +79,7 @@ Traffic::TrafficDataProvider::TrafficDataProvider(QObject *parent) : Positioning
     connect(this, &Traffic::TrafficDataProvider::positionInfoChanged, this, &Traffic::TrafficDataProvider::updateStatusString);
     connect(this, &Traffic::TrafficDataProvider::pressureAltitudeChanged, this, &Traffic::TrafficDataProvider::updateStatusString);
     connect(this, &Traffic::TrafficDataProvider::receivingHeartbeatChanged, this, &Traffic::TrafficDataProvider::updateStatusString);
+    connect(this, &Traffic::TrafficDataProvider::timeToFirstHeartbeatChanged, this, &Traffic::TrafficDataProvider::updateStatusString);
 
     // Connect timer. Try to (re)connect after 2s, and then again every five minutes.
     QTimer::singleShot(2s, this, &Traffic::TrafficDataProvider::connectToTrafficReceiver);
@@ -86,6 +96,41 @@ Traffic::TrafficDataProvider::TrafficDataProvider(QObject *parent) : Positioning
 }
 
 
+auto Traffic::TrafficDataProvider::acceptFusedFactor(const QString& ID) -> bool
+{
+    if (!m_fusion || ID.isEmpty())
+    {
+        return true;
+    }
+    auto* source = qobject_cast<Traffic::TrafficDataSource_Abstract*>(sender());
+    if (source == nullptr)
+    {
+        return true;
+    }
+    auto priority = m_dataSources.indexOf(source);
+
+    // Drop the report if the same target has recently been reported by a
+    // source of higher priority
+    auto key = fusionKey(ID);
+    auto iterator = m_fusionTable.find(key);
+    if ((iterator != m_fusionTable.end())
+        && (iterator->priority < priority)
+        && !iterator->freshness.hasExpired())
+    {
+        return false;
+    }
+
+    // Remove stale entries from time to time, so that the table does not grow
+    // indefinitely
+    if (m_fusionTable.size() > maxFusionTableSize)
+    {
+        m_fusionTable.removeIf([](const QHash<QString, FusionEntry>::iterator& entry) { return entry->freshness.hasExpired(); });
+    }
+    m_fusionTable.insert(key, {priority, QDeadlineTimer(fusionFreshness)});
+    return true;
+}
+
+
 void Traffic::TrafficDataProvider::clearDataSources()
 {
     foreach(auto dataSource, m_dataSources)
@@ -107,6 +152,7 @@ void Traffic::TrafficDataProvider::addDataSource(Traffic::TrafficDataSource_Abst
     Q_ASSERT( source != nullptr );
 
     source->setParent(this);
+    source->setCapture(m_capture);
     m_dataSources << source;
     connect(source, &Traffic::TrafficDataSource_Abstract::connectivityStatusChanged, this, &Traffic::TrafficDataProvider::updateStatusString);
     connect(source, &Traffic::TrafficDataSource_Abstract::errorStringChanged, this, &Traffic::TrafficDataProvider::updateStatusString);
@@ -122,12 +168,24 @@ void Traffic::TrafficDataProvider::addDataSource(Traffic::TrafficDataSource_Abst
 
 void Traffic::TrafficDataProvider::connectToTrafficReceiver()
 {
+    // (Re)start measuring the time to first heartbeat, so that the
+    // measurement refers to the most recent connection attempt
+    if (m_currentSource.isNull())
+    {
+        m_fastAttachTimer.start();
+    }
+
+    QDeadlineTimer fastAttachDeadline(fastAttachDuration);
     foreach(auto dataSource, m_dataSources)
     {
         if (dataSource.isNull())
         {
             continue;
         }
+        if (m_currentSource.isNull())
+        {
+            dataSource->setFastAttachDeadline(fastAttachDeadline);
+        }
         dataSource->connectToTrafficReceiver();
     }
 }
@@ -137,6 +195,12 @@ void Traffic::TrafficDataProvider::deferredInitialization() const
 {
     // Try to (re)connect whenever the network situation changes
     connect(GlobalObject::platformAdaptor(), &Platform::PlatformAdaptor_Abstract::wifiConnected, this, &Traffic::TrafficDataProvider::connectToTrafficReceiver);
+
+    // Attach registrations once the Flarmnet database has found them
+    connect(GlobalObject::flarmnetDB(), &Traffic::FlarmnetDB::registrationFound, this, &Traffic::TrafficDataProvider::onRegistrationFound);
+
+    // Predict conflicts whenever a new position of the own aircraft is known
+    connect(GlobalObject::positionProvider(), &Positioning::PositionProvider::positionInfoChanged, this, &Traffic::TrafficDataProvider::updatePredictedWarning);
 }
 
 
@@ -153,12 +217,89 @@ void Traffic::TrafficDataProvider::disconnectFromTrafficReceiver()
 }
 
 
+auto Traffic::TrafficDataProvider::fusionKey(const QString& ID) -> QString
+{
+    // GDL90 IDs consist of the address type and the 24-bit address. Address
+    // types 0 (ADS-B) and 2 (TIS-B) denote ICAO addresses, which FLARM devices
+    // report without address type.
+    if ((ID.size() == 7) && ((ID[0] == u'0') || (ID[0] == u'2')))
+    {
+        return ID.mid(1);
+    }
+
+    // FLARM IDs may carry the registration, separated by '!'
+    return ID.section('!', 0, 0);
+}
+
+
 void Traffic::TrafficDataProvider::foreFlightBroadcast()
 {
     foreFlightBroadcastSocket.writeDatagram(foreFlightBroadcastDatagram);
 }
 
 
+void Traffic::TrafficDataProvider::onLifeTimeWheelTick()
+{
+    m_lifeTimeWheelTick++;
+    QVector<LifeTimeWheelEntry> entries;
+    entries.swap(m_lifeTimeWheel[m_lifeTimeWheelTick % lifeTimeWheelSize]);
+
+    QVector<Traffic::TrafficFactor_Abstract*> expired;
+    foreach(auto entry, entries)
+    {
+        // Ignore entries that have been superseded by a later call to startLiveTime()
+        if (m_lifeTimeWheelDue.value(entry.factor, -1) != entry.tick)
+        {
+            continue;
+        }
+
+        // If the timer fired a little early, look again at the next tick
+        if (!entry.factor->lifeTimeDeadline().hasExpired())
+        {
+            scheduleLifeTimeExpiry(entry.factor, 1);
+            continue;
+        }
+
+        m_lifeTimeWheelDue.remove(entry.factor);
+        expired << entry.factor;
+    }
+
+    // Invalidate all expired traffic objects first. Every object still emits
+    // its own validChanged(), because each map item binds to the property of
+    // its own object. Everything that depends on the set of valid objects is
+    // then recomputed once for the whole batch, rather than once per object.
+    foreach(auto* factor, expired)
+    {
+        factor->checkLiveTime();
+    }
+    if (!expired.isEmpty())
+    {
+        updatePredictedWarning();
+    }
+
+    if (m_lifeTimeWheelDue.isEmpty())
+    {
+        m_lifeTimeWheelTimer.stop();
+    }
+}
+
+
+void Traffic::TrafficDataProvider::onRegistrationFound(const QString& ID, const QString& registration)
+{
+    foreach(auto target, m_trafficObjects)
+    {
+        if ((target->ID() == ID) && target->callSign().isEmpty())
+        {
+            target->setCallSign(registration);
+        }
+    }
+    if ((m_trafficObjectWithoutPosition->ID() == ID) && m_trafficObjectWithoutPosition->callSign().isEmpty())
+    {
+        m_trafficObjectWithoutPosition->setCallSign(registration);
+    }
+}
+
+
 void Traffic::TrafficDataProvider::onSourceHeartbeatChanged()
 {
     // If we have a current source, if the current source has a heartbeat and if the current source is a TCP source, then we simply stick with it.
@@ -166,6 +307,7 @@ void Traffic::TrafficDataProvider::onSourceHeartbeatChanged()
             && m_currentSource->receivingHeartbeat() )
     {
         setReceivingHeartbeat(true);
+        updateTrafficConnections();
         return;
     }
 
@@ -193,10 +335,7 @@ void Traffic::TrafficDataProvider::onSourceHeartbeatChanged()
         if (!m_currentSource.isNull())
         {
             disconnect(m_currentSource, &Traffic::TrafficDataSource_Abstract::pressureAltitudeUpdated, this, &Traffic::TrafficDataProvider::setPressureAltitude);
-            disconnect(m_currentSource, &Traffic::TrafficDataSource_Abstract::factorWithoutPosition, this, &Traffic::TrafficDataProvider::onTrafficFactorWithoutPosition);
-            disconnect(m_currentSource, &Traffic::TrafficDataSource_Abstract::factorWithPosition, this, &Traffic::TrafficDataProvider::onTrafficFactorWithPosition);
             disconnect(m_currentSource, &Traffic::TrafficDataSource_Abstract::positionUpdated, this, &Traffic::TrafficDataProvider::setPositionInfo);
-            disconnect(m_currentSource, &Traffic::TrafficDataSource_Abstract::warning, this, &Traffic::TrafficDataProvider::setWarning);
         }
 
         // Update m_currentsource
@@ -207,12 +346,27 @@ void Traffic::TrafficDataProvider::onSourceHeartbeatChanged()
             // If there is a new m_currentSource, then setup Qt connections and
             // disconnect all sources of lower priority from the traffic receivers.
             connect(m_currentSource, &Traffic::TrafficDataSource_Abstract::pressureAltitudeUpdated, this, &Traffic::TrafficDataProvider::setPressureAltitude);
-            connect(m_currentSource, &Traffic::TrafficDataSource_Abstract::factorWithoutPosition, this, &Traffic::TrafficDataProvider::onTrafficFactorWithoutPosition);
-            connect(m_currentSource, &Traffic::TrafficDataSource_Abstract::factorWithPosition, this, &Traffic::TrafficDataProvider::onTrafficFactorWithPosition);
             connect(m_currentSource, &Traffic::TrafficDataSource_Abstract::positionUpdated, this, &Traffic::TrafficDataProvider::setPositionInfo);
-            connect(m_currentSource, &Traffic::TrafficDataSource_Abstract::warning, this, &Traffic::TrafficDataProvider::setWarning);
 
-            // Disconnect from traffic receiver
+            // The first source with heartbeat wins the race: end fast attach
+            // for all sources and record the time to first heartbeat
+            foreach(auto source, m_dataSources)
+            {
+                if ( !source.isNull() )
+                {
+                    source->setFastAttachDeadline(QDeadlineTimer(0));
+                }
+            }
+            if (m_fastAttachTimer.isValid())
+            {
+                m_timeToFirstHeartbeat = Units::Time::fromMS(static_cast<double>(m_fastAttachTimer.elapsed()));
+                m_fastAttachTimer.invalidate();
+                qInfo() << "Time to first heartbeat" << m_timeToFirstHeartbeat.toS() << "s, via" << m_currentSource->sourceName();
+                emit timeToFirstHeartbeatChanged();
+            }
+
+            // Disconnect all sources of lower priority from the traffic
+            // receivers, unless traffic from several sources is fused
             bool doDisconnect = false;
             foreach(auto source, m_dataSources)
             {
@@ -222,7 +376,7 @@ void Traffic::TrafficDataProvider::onSourceHeartbeatChanged()
                 }
                 if (source == m_currentSource)
                 {
-                    doDisconnect = true;
+                    doDisconnect = !m_fusion;
                     continue;
                 }
                 if (doDisconnect)
@@ -251,24 +405,48 @@ void Traffic::TrafficDataProvider::onSourceHeartbeatChanged()
     {
         setReceivingHeartbeat(m_currentSource->receivingHeartbeat());
     }
+
+    updateTrafficConnections();
+}
+
+
+void Traffic::TrafficDataProvider::onSourceWarning(const Traffic::Warning& warning)
+{
+    // With fusion, several sources may issue warnings at the same time. Keep
+    // the warning with the highest alarm level. The source of the current
+    // warning may always update it, so that it can lower or clear its alarm.
+    auto* source = qobject_cast<Traffic::TrafficDataSource_Abstract*>(sender());
+    if (m_fusion
+        && (source != m_warningSource)
+        && !m_warningSource.isNull()
+        && (warning.alarmLevel() < m_Warning.alarmLevel()))
+    {
+        return;
+    }
+    m_warningSource = source;
+    setWarning(warning);
 }
 
 
 void Traffic::TrafficDataProvider::onTrafficFactorWithoutPosition(const Traffic::TrafficFactor_DistanceOnly &factor)
 {
+    if (!acceptFusedFactor(factor.ID()))
+    {
+        return;
+    }
 
-    if (factor.ID() == m_trafficObjectWithoutPosition->ID())
+    if (targetKey(factor.ID()) == targetKey(m_trafficObjectWithoutPosition->ID()))
     {
         m_trafficObjectWithoutPosition->setAnimate(true);
         m_trafficObjectWithoutPosition->copyFrom(factor);
-        m_trafficObjectWithoutPosition->startLiveTime();
+        startLiveTime(m_trafficObjectWithoutPosition);
     }
 
     if (factor.hasHigherPriorityThan(*m_trafficObjectWithoutPosition))
     {
         m_trafficObjectWithoutPosition->setAnimate(false);
         m_trafficObjectWithoutPosition->copyFrom(factor);
-        m_trafficObjectWithoutPosition->startLiveTime();
+        startLiveTime(m_trafficObjectWithoutPosition);
     }
 
 }
@@ -276,6 +454,12 @@ void Traffic::TrafficDataProvider::onTrafficFactorWithoutPosition(const Traffic:
 
 void Traffic::TrafficDataProvider::onTrafficFactorWithPosition(const Traffic::TrafficFactor_WithPosition &factor)
 {
+    if (!acceptFusedFactor(factor.ID()))
+    {
+        return;
+    }
+
+    recordLatency(Traffic::LatencyStatistics::Factor, Traffic::LatencyStatistics::ProviderUpdated);
 
     // Check if traffic is too far away to be shown
     bool farAway = false;
@@ -289,22 +473,28 @@ void Traffic::TrafficDataProvider::onTrafficFactorWithPosition(const Traffic::Tr
     }
 
 
-    // Check if the traffic is one of the known factors.
+    // Check if the traffic is one of the known factors. With fusion, this
+    // includes factors that another source has reported.
+    auto key = targetKey(factor.ID());
     foreach(auto target, m_trafficObjects)
     {
-        if (factor.ID() == target->ID())
+        if (key == targetKey(target->ID()))
         {
             // If traffic is too far away, delete the entry. Otherwise, replace the entry by the factor.
             if (farAway)
             {
                 target->setAnimate(false);
                 target->copyFrom(TrafficFactor_WithPosition());
+                target->setTrail({});
+                target->setTurnRate(qQNaN());
             }
             else
             {
                 target->setAnimate(true);
                 target->copyFrom(factor);
-                target->startLiveTime();
+                updateTrackHistory(target);
+                recordLatency(Traffic::LatencyStatistics::Factor, Traffic::LatencyStatistics::PropertyChanged);
+                startLiveTime(target);
             }
             return;
         }
@@ -327,7 +517,9 @@ void Traffic::TrafficDataProvider::onTrafficFactorWithPosition(const Traffic::Tr
     {
         lowestPriObject->setAnimate(false);
         lowestPriObject->copyFrom(factor);
-        lowestPriObject->startLiveTime();
+        updateTrackHistory(lowestPriObject);
+        recordLatency(Traffic::LatencyStatistics::Factor, Traffic::LatencyStatistics::PropertyChanged);
+        startLiveTime(lowestPriObject);
     }
 
 }
@@ -387,12 +579,102 @@ void Traffic::TrafficDataProvider::onTrafficReceiverSelfTestError(const QString&
 }
 
 
+void Traffic::TrafficDataProvider::recordFrameSwapped()
+{
+    for(int path=Traffic::LatencyStatistics::Warning; path<=Traffic::LatencyStatistics::Factor; path++)
+    {
+        if (m_latencyPendingDisplay[path] < 0)
+        {
+            continue;
+        }
+        auto latencyNS = m_latencyStatistics.record(static_cast<Traffic::LatencyStatistics::Path>(path), Traffic::LatencyStatistics::Displayed, m_latencyPendingDisplay[path]);
+        if ((path == Traffic::LatencyStatistics::Warning) && (latencyNS > std::chrono::nanoseconds(Traffic::LatencyStatistics::warningBudget).count()))
+        {
+            qWarning() << "Traffic warning displayed after" << latencyNS/1000000 << "ms";
+        }
+        m_latencyPendingDisplay[path] = -1;
+    }
+}
+
+
+void Traffic::TrafficDataProvider::recordLatency(Traffic::LatencyStatistics::Path path, Traffic::LatencyStatistics::Stage stage)
+{
+    auto* source = qobject_cast<Traffic::TrafficDataSource_Abstract*>(sender());
+    if (source == nullptr)
+    {
+        return;
+    }
+    auto stamps = source->latencyStamps();
+    if ((stage == Traffic::LatencyStatistics::ProviderUpdated) && (stamps.decoded >= 0))
+    {
+        m_latencyStatistics.record(path, Traffic::LatencyStatistics::Decoded, stamps.received, stamps.decoded);
+    }
+    m_latencyStatistics.record(path, stage, stamps.received);
+    if ((stage == Traffic::LatencyStatistics::PropertyChanged) && (stamps.received >= 0) && (m_latencyPendingDisplay[path] < 0))
+    {
+        m_latencyPendingDisplay[path] = stamps.received;
+    }
+}
+
+
 void Traffic::TrafficDataProvider::resetWarning()
 {
     setWarning( Traffic::Warning() );
 }
 
 
+void Traffic::TrafficDataProvider::scheduleLifeTimeExpiry(Traffic::TrafficFactor_Abstract* factor, qint64 ticks)
+{
+    auto due = m_lifeTimeWheelTick + ticks;
+    m_lifeTimeWheelDue[factor] = due;
+    m_lifeTimeWheel[due % lifeTimeWheelSize].append({factor, due});
+    if (!m_lifeTimeWheelTimer.isActive())
+    {
+        m_lifeTimeWheelTimer.start();
+    }
+}
+
+
+void Traffic::TrafficDataProvider::setCaptureFile(const QString& fileName, qint64 capacity)
+{
+    delete m_capture;
+    if (!fileName.isEmpty())
+    {
+        m_capture = new Traffic::TrafficCapture(fileName, capacity, this);
+        if (!m_capture->isValid())
+        {
+            delete m_capture;
+        }
+    }
+
+    foreach(auto dataSource, m_dataSources)
+    {
+        if (dataSource.isNull())
+        {
+            continue;
+        }
+        dataSource->setCapture(m_capture);
+    }
+}
+
+
+void Traffic::TrafficDataProvider::setFusion(bool newFusion)
+{
+    if (m_fusion == newFusion)
+    {
+        return;
+    }
+    m_fusion = newFusion;
+    m_fusionTable.clear();
+    if (m_fusion)
+    {
+        connectToTrafficReceiver();
+    }
+    updateTrafficConnections();
+    emit fusionChanged();
+}
+
+
 void Traffic::TrafficDataProvider::setPassword(const QString& SSID, const QString &password)
 {
     foreach(auto dataSource, m_dataSources)
@@ -420,6 +702,8 @@ void Traffic::TrafficDataProvider::setReceivingHeartbeat(bool newReceivingHeartb
 
 void Traffic::TrafficDataProvider::setWarning(const Traffic::Warning& warning)
 {
+    recordLatency(Traffic::LatencyStatistics::Warning, Traffic::LatencyStatistics::ProviderUpdated);
+
     if (warning.alarmLevel() > -1)
     {
         m_WarningTimer.start();
@@ -432,6 +716,48 @@ void Traffic::TrafficDataProvider::setWarning(const Traffic::Warning& warning)
 
     m_Warning = warning;
     emit warningChanged(m_Warning);
+    recordLatency(Traffic::LatencyStatistics::Warning, Traffic::LatencyStatistics::PropertyChanged);
+}
+
+
+void Traffic::TrafficDataProvider::startLiveTime(Traffic::TrafficFactor_Abstract* factor)
+{
+    factor->startLiveTime();
+    scheduleLifeTimeExpiry(factor, lifeTimeWheelTicks);
+}
+
+
+auto Traffic::TrafficDataProvider::targetKey(const QString& ID) const -> QString
+{
+    if (m_fusion)
+    {
+        return fusionKey(ID);
+    }
+    return ID;
+}
+
+
+void Traffic::TrafficDataProvider::updatePredictedWarning()
+{
+    m_conflictPredictor.clear();
+    m_conflictPredictor.reserve(m_trafficObjects.size());
+    m_conflictPredictor.setOwnship(GlobalObject::positionProvider()->positionInfo());
+    foreach(auto target, m_trafficObjects)
+    {
+        if (!target->valid())
+        {
+            continue;
+        }
+        m_conflictPredictor.addTarget(target->positionInfo());
+    }
+
+    auto predictedWarning = m_conflictPredictor.warning(m_conflictPredictor.predict());
+    if (m_predictedWarning == predictedWarning)
+    {
+        return;
+    }
+    m_predictedWarning = predictedWarning;
+    emit predictedWarningChanged(m_predictedWarning);
 }
 
 
@@ -445,6 +771,10 @@ void Traffic::TrafficDataProvider::updateStatusString()
             result += QStringLiteral("<p>%1</p><ul style='margin-left:-25px;'>").arg(m_currentSource->sourceName());
         }
         result += QStringLiteral("<li>%1</li>").arg(tr("Receiving heartbeat."));
+        if (m_timeToFirstHeartbeat.isFinite())
+        {
+            result += QStringLiteral("<li>%1</li>").arg(tr("First heartbeat after %1 s.").arg(m_timeToFirstHeartbeat.toS(), 0, 'f', 1));
+        }
         if (positionInfo().isValid())
         {
             result += QStringLiteral("<li>%1</li>").arg(tr("Receiving position info."));
@@ -478,3 +808,48 @@ void Traffic::TrafficDataProvider::updateStatusString()
 
     setStatusString(result);
 }
+
+
+void Traffic::TrafficDataProvider::updateTrackHistory(Traffic::TrafficFactor_WithPosition* target)
+{
+    QGeoPositionInfo info = target->positionInfo();
+    auto key = targetKey(target->ID());
+    m_trackHistory.append(key, info);
+
+    if (!info.hasAttribute(QGeoPositionInfo::VerticalSpeed))
+    {
+        auto climbRate = m_trackHistory.climbRate(key);
+        if (climbRate.isFinite())
+        {
+            info.setAttribute(QGeoPositionInfo::VerticalSpeed, climbRate.toMPS());
+            target->setPositionInfo(Positioning::PositionInfo(info));
+        }
+    }
+    target->setTrail(m_trackHistory.trail(key));
+    target->setTurnRate(m_trackHistory.turnRate(key));
+}
+
+
+void Traffic::TrafficDataProvider::updateTrafficConnections()
+{
+    foreach(auto source, m_dataSources)
+    {
+        if (source.isNull())
+        {
+            continue;
+        }
+
+        if ((source == m_currentSource) || (m_fusion && source->receivingHeartbeat()))
+        {
+            connect(source, &Traffic::TrafficDataSource_Abstract::factorWithoutPosition, this, &Traffic::TrafficDataProvider::onTrafficFactorWithoutPosition, Qt::UniqueConnection);
+            connect(source, &Traffic::TrafficDataSource_Abstract::factorWithPosition, this, &Traffic::TrafficDataProvider::onTrafficFactorWithPosition, Qt::UniqueConnection);
+            connect(source, &Traffic::TrafficDataSource_Abstract::warning, this, &Traffic::TrafficDataProvider::onSourceWarning, Qt::UniqueConnection);
+        }
+        else
+        {
+            disconnect(source, &Traffic::TrafficDataSource_Abstract::factorWithoutPosition, this, &Traffic::TrafficDataProvider::onTrafficFactorWithoutPosition);
+            disconnect(source, &Traffic::TrafficDataSource_Abstract::factorWithPosition, this, &Traffic::TrafficDataProvider::onTrafficFactorWithPosition);
+            disconnect(source, &Traffic::TrafficDataSource_Abstract::warning, this, &Traffic::TrafficDataProvider::onSourceWarning);
+        }
+    }
+}
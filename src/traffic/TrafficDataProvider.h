@@ -20,15 +20,23 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QNetworkDatagram>
 #include <QPointer>
 #include <QQmlListProperty>
+#include <QTimer>
 #include <QUdpSocket>
+#include <array>
 
 #include "positioning/PositionInfoSource_Abstract.h"
+#include "traffic/ConflictPredictor.h"
+#include "traffic/LatencyStatistics.h"
+#include "traffic/TrackHistory.h"
+#include "traffic/TrafficCapture.h"
 #include "traffic/TrafficFactor_DistanceOnly.h"
 #include "traffic/TrafficFactor_WithPosition.h"
 #include "traffic/Warning.h"
+#include "units/Time.h"
 
 
 namespace Traffic {
@@ -47,6 +55,10 @@ namespace Traffic {
  *  This class also acts as a PositionInfoSource, and passes position data (that
  *  some traffic receivers provide) on to the the consumers of this class.
  *
+ *  By default, traffic is taken from a single data source, the most preferred
+ *  source that receives heartbeat messages. If the property "fusion" is set,
+ *  traffic from all data sources with heartbeat is merged instead.
+ *
  *  Following the standards established by the app ForeFlight, this classEnroute
  *  broadcasts a UDP message on port 63093 every 5 seconds while the app is
  *  running in the foreground. This message allows devices to discover Enroute’s
@@ -79,10 +91,74 @@ public:
     /*! \brief Clear all data sources */
     void clearDataSources();
 
+    /*! \brief Record raw data from all data sources
+     *
+     *  This method opens a capture file and records all raw data received by
+     *  any of the data sources, including sources that are added later. The
+     *  capture file can be replayed with TrafficDataSource_File.  Any
+     *  previous capture is closed.
+     *
+     *  @param fileName Name of the capture file. Pass an empty string to stop
+     *  recording.
+     *
+     *  @param capacity Size of the capture ring buffer, in bytes
+     */
+    void setCaptureFile(const QString& fileName, qint64 capacity = Traffic::TrafficCapture::defaultCapacity);
+
+    /*! \brief Latency statistics
+     *
+     *  The traffic data path is instrumented with time stamps, taken when data
+     *  is read from the socket, when it is decoded, when it reaches this class
+     *  and when the notifier signals of the properties seen by QML have
+     *  returned.  If recordFrameSwapped() is connected to the window, the time
+     *  at which the data reaches the screen is recorded as well.
+     *
+     *  @returns Human-readable latency histograms, for log output or for
+     *  display on a debug page
+     */
+    Q_INVOKABLE [[nodiscard]] QString latencyReport() const
+    {
+        return m_latencyStatistics.report();
+    }
+
     //
     // Properties
     //
 
+    /*! \brief Fusion of several traffic data sources
+     *
+     *  If false, traffic is taken only from the most preferred data source
+     *  that receives heartbeat messages, and all less preferred sources are
+     *  disconnected.  If true, traffic is taken from all data sources that
+     *  receive heartbeat messages, for instance from a FLARM receiver and an
+     *  ADS-B receiver at the same time.  Reports are merged by target ID,
+     *  where ICAO addresses reported by FLARM and GDL90 receivers are
+     *  identified, so that every target is shown by one traffic object: if a
+     *  target has been reported by a more preferred source within the last
+     *  fusionFreshness, reports of less preferred sources are ignored.
+     *  Otherwise, the report updates the traffic object of the target, no
+     *  matter which source has reported it before.
+     *  Traffic warnings are taken from all these sources, and the warning with
+     *  the highest alarm level is shown.  Position and pressure altitude are
+     *  always taken from the most preferred source.
+     */
+    Q_PROPERTY(bool fusion READ fusion WRITE setFusion NOTIFY fusionChanged)
+
+    /*! \brief Getter method for property with the same name
+     *
+     *  @returns Property fusion
+     */
+    [[nodiscard]] auto fusion() const -> bool
+    {
+        return m_fusion;
+    }
+
+    /*! \brief Setter method for property with the same name
+     *
+     *  @param newFusion Property fusion
+     */
+    void setFusion(bool newFusion);
+
     /*! \brief Heartbeat indicator
      *
      *  When active, traffic receivers send regular heartbeat messages. These
@@ -190,6 +266,68 @@ public:
         return m_Warning;
     }
 
+    /*! \brief Predicted traffic warning
+     *
+     *  This property holds a traffic warning that is computed by the app
+     *  itself, independently of the traffic receiver.  Whenever a new position
+     *  of the own aircraft becomes available, the closest points of approach
+     *  for all traffic objects are predicted with a ConflictPredictor.  The
+     *  property is set to the most urgent predicted conflict, or to an invalid
+     *  warning (i.e. one with alarmLevel == -1) if no conflict is predicted.
+     *  Since the prediction horizon is longer than that of FLARM devices,
+     *  conflicts are typically flagged well before the receiver issues an
+     *  alarm.  The moving map shows the predicted warning in its traffic
+     *  alarm banner whenever the traffic receiver does not issue an alarm.
+     */
+    Q_PROPERTY(Traffic::Warning predictedWarning READ predictedWarning NOTIFY predictedWarningChanged)
+
+    /*! \brief Getter method for property with the same name
+     *
+     *  @returns Property predictedWarning
+     */
+    [[nodiscard]] auto predictedWarning() const -> Traffic::Warning
+    {
+        return m_predictedWarning;
+    }
+
+    /*! \brief Time to first heartbeat
+     *
+     *  This property holds the time between the start of the most recent
+     *  connection attempt (see connectToTrafficReceiver()) and the first
+     *  heartbeat received by any data source.  The property is invalid if no
+     *  heartbeat has been received since the program started.  The value is
+     *  shown in the statusString.
+     */
+    Q_PROPERTY(Units::Time timeToFirstHeartbeat READ timeToFirstHeartbeat NOTIFY timeToFirstHeartbeatChanged)
+
+    /*! \brief Getter method for property with the same name
+     *
+     *  @returns Property timeToFirstHeartbeat
+     */
+    [[nodiscard]] auto timeToFirstHeartbeat() const -> Units::Time
+    {
+        return m_timeToFirstHeartbeat;
+    }
+
+    /*! \brief Duration of fast attach
+     *
+     *  After connectToTrafficReceiver() has been called, TCP data sources retry
+     *  failed connection attempts with short timeouts and exponential backoff
+     *  for this period, or until the first heartbeat is received.
+     */
+    static constexpr auto fastAttachDuration = 30s;
+
+    /*! \brief Period for which a fused target stays with its source
+     *
+     *  If the source does not report the target within this period, a less
+     *  preferred source takes over the target.  Since reports of all sources
+     *  update the same traffic object, the takeover does not create a second
+     *  object, even though the period is shorter than
+     *  TrafficFactor_Abstract::lifeTime.  See the documentation of the property
+     *  "fusion".
+     */
+    static constexpr auto fusionFreshness = 3s;
+
     /*! \brief Maximal vertical distance for relevant traffic
      *
      *  Traffic whose vertical distance to the own aircraft is larger than this
@@ -205,6 +343,9 @@ public:
     static constexpr Units::Distance maxHorizontalDistance = Units::Distance::fromNM(20.0);
 
 signals:
+    /*! \brief Notifier signal */
+    void fusionChanged();
+
     /*! \brief Password request
      *
      *  This signal is emitted whenever one of the traffic data sources requires
@@ -222,9 +363,15 @@ signals:
      */
     void passwordStorageRequest(const QString& SSID, const QString& password);
 
+    /*! \brief Notifier signal */
+    void predictedWarningChanged(const Traffic::Warning&);
+
     /*! \brief Notifier signal */
     void receivingHeartbeatChanged(bool);
 
+    /*! \brief Notifier signal */
+    void timeToFirstHeartbeatChanged();
+
     /*! \brief Notifier signal */
     void trafficReceiverRuntimeErrorChanged(QString message);
 
@@ -240,7 +387,9 @@ public slots:
      * If this class is connected to a traffic receiver, this method does
      * nothing.  Otherwise, it stops any ongoing connection attempt and starts a
      * new attempt to connect to a potential receiver, via all available
-     * channels simultaneously.
+     * channels simultaneously.  The data sources race in fast-attach mode (see
+     * fastAttachDuration); the first source that receives a heartbeat ends the
+     * race.
      */
     void connectToTrafficReceiver();
 
@@ -250,6 +399,17 @@ public slots:
      */
     void disconnectFromTrafficReceiver();
 
+    /*! \brief Record that a frame has been swapped to screen
+     *
+     *  Connect this slot to the signal QQuickWindow::frameSwapped in order to
+     *  measure the latency until traffic data is visible on screen.  The
+     *  signal is emitted by the render thread, so a queued connection must be
+     *  used; the measured latency then includes the delivery of the queued
+     *  event.  Traffic warnings that are displayed later than
+     *  Traffic::LatencyStatistics::warningBudget are reported with qWarning.
+     */
+    void recordFrameSwapped();
+
     /*! \brief Send password to the traffic data sources
      *
      *  This method will send a password/ssid combination to all traffic data
@@ -274,6 +434,20 @@ private slots:
     // Called if one of the sources indicates a heartbeat change
     void onSourceHeartbeatChanged();
 
+    // Called when the Flarmnet database has found a registration
+    void onRegistrationFound(const QString& ID, const QString& registration);
+
+    // Advances the timing wheel for the lifetimes of traffic objects by one
+    // slot, and invalidates all traffic objects whose lifetime has expired.
+    // If any object expired, the property predictedWarning is recomputed
+    // once for the whole batch.
+    void onLifeTimeWheelTick();
+
+    // Called if one of the sources issues a traffic warning. With fusion,
+    // warnings of lower alarm level than the current one are ignored, unless
+    // they come from the source of the current warning.
+    void onSourceWarning(const Traffic::Warning& warning);
+
     // Called if one of the sources reports traffic (position unknown)
     void onTrafficFactorWithPosition(const Traffic::TrafficFactor_WithPosition& factor);
 
@@ -295,11 +469,55 @@ private slots:
     // Setter method
     void setWarning(const Traffic::Warning& warning);
 
+    // Recomputes the property predictedWarning
+    void updatePredictedWarning();
+
     // Updates the property statusString that is inherited from
     // Positioning::PositionInfoSource_Abstract
     void updateStatusString();
 
 private:
+    // If fusion is enabled, decides whether a report of the target with the
+    // given ID, sent by the sender() of the current signal, should be used.
+    // Reports are accepted unless the same target has been reported by a more
+    // preferred source within fusionFreshness.  Always returns true if fusion
+    // is disabled.
+    auto acceptFusedFactor(const QString& ID) -> bool;
+
+    // Returns the key of the target with the given ID in m_fusionTable. Targets
+    // with ICAO addresses have the same key, regardless of whether they are
+    // reported by FLARM or GDL90 receivers.
+    [[nodiscard]] static auto fusionKey(const QString& ID) -> QString;
+
+    // Returns the key by which traffic objects and their track histories are
+    // identified: the fusionKey() if fusion is enabled, and the ID otherwise
+    [[nodiscard]] auto targetKey(const QString& ID) const -> QString;
+
+    // Connects the traffic and warning signals of the current source, and of
+    // all sources with heartbeat if fusion is enabled.  Disconnects all other
+    // sources.
+    void updateTrafficConnections();
+
+    // Starts or extends the lifetime of a traffic object that is owned by this
+    // class, and schedules the expiry in the timing wheel
+    void startLiveTime(Traffic::TrafficFactor_Abstract* factor);
+
+    // Schedules the expiry of a traffic object in the timing wheel, the given
+    // number of ticks from now
+    void scheduleLifeTimeExpiry(Traffic::TrafficFactor_Abstract* factor, qint64 ticks);
+
+    // If the current signal was sent by a data source, records the latency of
+    // the data that led to the signal.  At stage ProviderUpdated, the latency
+    // of stage Decoded is recorded as well. At stage PropertyChanged, the data
+    // is scheduled for stage Displayed, see recordFrameSwapped().
+    void recordLatency(Traffic::LatencyStatistics::Path path, Traffic::LatencyStatistics::Stage stage);
+
+    // Records the position of a traffic object that is owned by this class in
+    // m_trackHistory, and updates trail and turn rate of the object.  If the
+    // traffic receiver has not reported a climb rate, the estimated climb rate
+    // is added to the position info.
+    void updateTrackHistory(Traffic::TrafficFactor_WithPosition* target);
+
     // UDP Socket for ForeFlight Broadcast messages.
     // See https://www.foreflight.com/connect/spec/
     QNetworkDatagram foreFlightBroadcastDatagram {R"({"App":"Enroute Flight Navigation","GDL90":{"port":4000}})", QHostAddress::Broadcast, 63093};
@@ -310,10 +528,61 @@ private:
     QList<Traffic::TrafficFactor_WithPosition *> m_trafficObjects;
     QPointer<Traffic::TrafficFactor_DistanceOnly> m_trafficObjectWithoutPosition;
 
+    // Recent positions of the targets
+    Traffic::TrackHistory m_trackHistory;
+
+    // Hashed timing wheel for the lifetimes of the targets. Every tick of
+    // m_lifeTimeWheelTimer advances the wheel by one slot. Each target is
+    // entered in the slot of the tick at which its lifetime expires, and
+    // m_lifeTimeWheelDue holds the most recent such tick. Entries whose tick
+    // does not match m_lifeTimeWheelDue have been superseded by a later call
+    // to startLiveTime() and are dropped when their slot comes up.
+    struct LifeTimeWheelEntry
+    {
+        Traffic::TrafficFactor_Abstract* factor {nullptr};
+        qint64 tick {0};
+    };
+    static constexpr auto lifeTimeWheelInterval = 1s;
+    static constexpr qint64 lifeTimeWheelTicks = Traffic::TrafficFactor_Abstract::lifeTime/lifeTimeWheelInterval + 1;
+    static constexpr qint64 lifeTimeWheelSize = 16;
+    static_assert(lifeTimeWheelTicks < lifeTimeWheelSize, "Timing wheel too small for lifeTime");
+    std::array<QVector<LifeTimeWheelEntry>, lifeTimeWheelSize> m_lifeTimeWheel;
+    QHash<Traffic::TrafficFactor_Abstract*, qint64> m_lifeTimeWheelDue;
+    qint64 m_lifeTimeWheelTick {0};
+    QTimer m_lifeTimeWheelTimer;
+
     // TrafficData Sources
     QList<QPointer<Traffic::TrafficDataSource_Abstract>> m_dataSources;
+
+    // Fusion. The table maps fusion keys to the index in m_dataSources of the
+    // source that last reported the target, and the end of that report's
+    // freshness.
+    struct FusionEntry
+    {
+        qsizetype priority {0};
+        QDeadlineTimer freshness {0};
+    };
+    static constexpr qsizetype maxFusionTableSize = 256;
+    bool m_fusion {false};
+    QHash<QString, FusionEntry> m_fusionTable;
+
+    // Capture for raw data, or nullptr if no data is recorded
+    QPointer<Traffic::TrafficCapture> m_capture;
     QPointer<Traffic::TrafficDataSource_Abstract> m_currentSource;
 
+    // Source of the current traffic warning
+    QPointer<Traffic::TrafficDataSource_Abstract> m_warningSource;
+
+    // Latency instrumentation. For every path, m_latencyPendingDisplay holds
+    // the time of reception of the oldest data that has changed properties
+    // since the last frame was swapped, or -1 if there is no such data.
+    Traffic::LatencyStatistics m_latencyStatistics;
+    std::array<qint64, 2> m_latencyPendingDisplay {-1, -1};
+
+    // Conflict prediction
+    Traffic::ConflictPredictor m_conflictPredictor;
+    Traffic::Warning m_predictedWarning;
+
     // Property cache
     Traffic::Warning m_Warning;
     QTimer m_WarningTimer;
@@ -323,6 +592,10 @@ private:
     // Reconnect
     QTimer reconnectionTimer;
 
+    // Fast attach. The timer is valid while no source receives a heartbeat.
+    QElapsedTimer m_fastAttachTimer;
+    Units::Time m_timeToFirstHeartbeat;
+
     // Property Cache
     bool m_receivingHeartbeat {false};
 };
@@ -40,6 +40,85 @@ Traffic::TrafficDataSource_Abstract::TrafficDataSource_Abstract(QObject *parent)
     m_trueAltitudeTimer.setInterval(5s);
     m_trueAltitudeTimer.setSingleShot(true);
 
+    // Setup clock for duplicate datagram detection
+    m_datagramClock.start();
+
+}
+
+
+auto Traffic::TrafficDataSource_Abstract::isDuplicateDatagram(QByteArrayView data, qint64 receptionTime) -> bool
+{
+    static_assert((recentDatagramsSize & (recentDatagramsSize-1)) == 0, "recentDatagramsSize must be a power of two");
+
+    auto hash = qHash(data);
+    auto now = receptionTime;
+
+    // Probe consecutive slots. Remember the slot to be used if the datagram
+    // turns out to be new: the first expired slot, or else the oldest slot.
+    auto start = static_cast<qsizetype>(hash & static_cast<size_t>(recentDatagramsSize-1));
+    auto* victim = &m_recentDatagrams[start];
+    for(qsizetype i=0; i<recentDatagramsMaxProbe; i++)
+    {
+        auto& slot = m_recentDatagrams[(start+i) & (recentDatagramsSize-1)];
+        auto expired = (now-slot.time > duplicateDatagramWindow);
+        if (!expired && (slot.hash == hash))
+        {
+            return true;
+        }
+        if (expired)
+        {
+            if (now-victim->time <= duplicateDatagramWindow)
+            {
+                victim = &slot;
+            }
+            continue;
+        }
+        if ((now-victim->time <= duplicateDatagramWindow) && (slot.time < victim->time))
+        {
+            victim = &slot;
+        }
+    }
+
+    victim->hash = hash;
+    victim->time = now;
+    return false;
+}
+
+
+void Traffic::TrafficDataSource_Abstract::processDatagram(QByteArrayView data, qint64 receptionTime)
+{
+    // Return immediately if the datagram has already been received.
+    if (receptionTime < 0)
+    {
+        receptionTime = m_datagramClock.elapsed();
+    }
+    if (isDuplicateDatagram(data, receptionTime))
+    {
+        return;
+    }
+
+    // Process datagrams, depending on content type
+    if (data.startsWith("XGPS") || data.startsWith("XTRA"))
+    {
+        processXGPSString(data);
+        return;
+    }
+
+    // Find GDL90 messages between the 0x7e flag bytes, without copying
+    qsizetype start = 0;
+    while (start < data.size())
+    {
+        auto end = data.indexOf('\x7e', start);
+        if (end < 0)
+        {
+            end = data.size();
+        }
+        if (end > start)
+        {
+            processGDLMessage(data.sliced(start, end-start));
+        }
+        start = end+1;
+    }
 }
 
 
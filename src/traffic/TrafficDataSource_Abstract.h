@@ -20,7 +20,15 @@
 
 #pragma once
 
+#include <QByteArrayView>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <array>
+
+#include "positioning/LocalTangentPlane.h"
 #include "positioning/PositionInfo.h"
+#include "traffic/LatencyStatistics.h"
+#include "traffic/TrafficCapture.h"
 #include "traffic/TrafficFactor_DistanceOnly.h"
 #include "traffic/TrafficFactor_WithPosition.h"
 #include "traffic/Warning.h"
@@ -301,7 +309,108 @@ public slots:
         Q_UNUSED(password)
     }
 
+    /*! \brief Set deadline for fast attach
+     *
+     *  Data sources that actively connect to a traffic receiver use short
+     *  connect timeouts until the deadline expires, and retry failed attempts
+     *  with exponential backoff.  Pass an expired deadline to end fast attach.
+     *  Data sources that passively wait for data ignore the deadline.  This
+     *  method does not start a connection attempt by itself.
+     *
+     *  @param deadline End of fast attach
+     */
+    virtual void setFastAttachDeadline(QDeadlineTimer deadline)
+    {
+        Q_UNUSED(deadline)
+    }
+
+    /*! \brief Record raw data
+     *
+     *  If set, raw data received by this source is written to the capture,
+     *  before it is interpreted. The data source does not take ownership of
+     *  the capture. Pass a nullptr to stop recording.
+     *
+     *  @param capture Capture to be written to
+     */
+    void setCapture(Traffic::TrafficCapture* capture)
+    {
+        m_capture = capture;
+    }
+
+    /*! \brief Time stamps of the data that is currently processed
+     *
+     *  Receivers of the signals factorWithPosition and warning can use this
+     *  method to find out when the data that led to the signal was received
+     *  and decoded.
+     *
+     *  @returns Time stamps, as returned by Traffic::LatencyStatistics::now()
+     */
+    [[nodiscard]] auto latencyStamps() const -> Traffic::LatencyStatistics::Stamps
+    {
+        return m_latencyStamps;
+    }
+
 protected:
+    /*! \brief Write raw data to the capture
+     *
+     *  Subclasses call this method with raw data received from the traffic
+     *  receiver, before the data is interpreted. If no capture has been set
+     *  with setCapture(), this method does nothing.
+     *
+     *  @param transport Transport over which data was received
+     *
+     *  @param port Port on which data was received
+     *
+     *  @param data Raw data, exactly as received
+     */
+    void captureRawData(Traffic::TrafficCapture::Transport transport, quint16 port, QByteArrayView data)
+    {
+        if (!m_capture.isNull()) {
+            m_capture->write(transport, port, data);
+        }
+    }
+
+    /*! \brief Record time of reception
+     *
+     *  Subclasses call this method when they read data from the traffic
+     *  receiver, before the data is interpreted.
+     */
+    void stampReceived()
+    {
+        m_latencyStamps.received = Traffic::LatencyStatistics::now();
+        m_latencyStamps.decoded = -1;
+    }
+
+    /*! \brief Record time of decoding
+     *
+     *  Called by the parsers right before a traffic factor or warning is
+     *  emitted.
+     */
+    void stampDecoded()
+    {
+        m_latencyStamps.decoded = Traffic::LatencyStatistics::now();
+    }
+
+    /*! \brief Process one datagram
+     *
+     *  This method expects one UDP datagram, containing either an XGPS string
+     *  or a sequence of GDL90 messages.  Datagrams that have already been
+     *  received within the last duplicateDatagramWindow milliseconds are
+     *  silently ignored, because some traffic receivers send every datagram
+     *  more than once.  The method interprets the data and updates the
+     *  properties and emits signals as appropriate.  The data is not copied;
+     *  GDL90 messages are decoded directly from the datagram.
+     *
+     *  @param data Datagram
+     *
+     *  @param receptionTime Time of reception in milliseconds, used to detect
+     *  duplicate datagrams. Replays of captured data pass the time stamps of
+     *  the capture, so that duplicates are detected exactly as they were when
+     *  the data was received, independent of the replay speed. If negative,
+     *  the current time is used.
+     */
+    void processDatagram(QByteArrayView data, qint64 receptionTime = -1);
+
     /*! \brief Process one FLARM/NMEA sentence
      *
      *  This method expects exactly one line containing a valid FLARM/NMEA
@@ -316,14 +425,14 @@ protected:
 
     /*! \brief Process one GDL90 message
      *
-     *  This method expects exactly one GDL90 message, including starting and
-     *  trailing 0x7e bytes.  The method interprets the string and updates the
-     *  properties and emits signals as appropriate. Invalid messages are
-     *  silently ignored.
+     *  This method expects exactly one GDL90 message, without the starting
+     *  and trailing 0x7e flag bytes.  The method interprets the string and
+     *  updates the properties and emits signals as appropriate. Invalid
+     *  messages are silently ignored.
      *
-     *  @param message A QByteArray containing a GDL90 message.
+     *  @param rawMessage GDL90 message, still byte-stuffed
      */
-    void processGDLMessage(const QByteArray& message);
+    void processGDLMessage(QByteArrayView rawMessage);
 
     /*! \brief Process one XGPS string
      *
@@ -332,11 +441,12 @@ protected:
      *  https://www.foreflight.com/support/network-gps/
      *
      *  The method interprets the string and updates the properties and emits
-     *  signals as appropriate. Invalid messages are silently ignored.
+     *  signals as appropriate. Invalid messages are silently ignored.  The
+     *  string is parsed in place, without conversion to QString.
      *
-     *  @param data A QByteArray containing an XGPS string.
+     *  @param data XGPS string
      */
-    void processXGPSString(const QByteArray& data);
+    void processXGPSString(QByteArrayView data);
 
     /*! \brief Resetter method for the property with the same name
      *
@@ -378,6 +488,34 @@ protected:
     void setTrafficReceiverSelfTestError(const QString& newErrorString);
 
 private:
+    // Capture for raw data
+    QPointer<Traffic::TrafficCapture> m_capture;
+
+    // Time stamps of the data that is currently processed
+    Traffic::LatencyStatistics::Stamps m_latencyStamps;
+
+    // Checks if the datagram has been received within duplicateDatagramWindow
+    // milliseconds before receptionTime. If not, the datagram is recorded.
+    auto isDuplicateDatagram(QByteArrayView data, qint64 receptionTime) -> bool;
+
+    // Small open-addressing hash set of recently received datagrams, used to
+    // sort out doubly sent datagrams. Each slot holds the hash of a datagram
+    // and the time of reception, as measured by m_datagramClock or as given
+    // by the time stamps of a capture. Slots older
+    // than duplicateDatagramWindow count as empty.  Lookups probe at most
+    // recentDatagramsMaxProbe consecutive slots, so lookup and insertion take
+    // constant time. If all probed slots are in use, the oldest is replaced.
+    static constexpr qint64 duplicateDatagramWindow = 500;
+    static constexpr qsizetype recentDatagramsSize = 2048;
+    static constexpr qsizetype recentDatagramsMaxProbe = 8;
+    struct RecentDatagram
+    {
+        size_t hash {0};
+        qint64 time {-duplicateDatagramWindow-1};
+    };
+    std::array<RecentDatagram, recentDatagramsSize> m_recentDatagrams;
+    QElapsedTimer m_datagramClock;
+
     // Property caches
     QString m_connectivityStatus {};
     QString m_errorString {};
@@ -399,6 +537,10 @@ private:
     Units::Distance m_pressureAltitude;
     QTimer m_pressureAltitudeTimer;
 
+    // Local tangent plane, anchored near the own aircraft. Used to convert
+    // relative positions of traffic to coordinates and back.
+    Positioning::LocalTangentPlane m_localTangentPlane;
+
     // Heartbeat timer
     QTimer m_heartbeatTimer;
     bool m_hasHeartbeat {false};
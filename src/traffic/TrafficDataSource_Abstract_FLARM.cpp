@@ -306,7 +306,7 @@ void Traffic::TrafficDataSource_Abstract::processFLARMSentence(QString sentence)
             }
 
             m_factorDistanceOnly.setAlarmLevel(alarmLevel);
-            m_factorDistanceOnly.setCallSign( GlobalObject::flarmnetDB()->getRegistration(targetID) );
+            m_factorDistanceOnly.setCallSign( GlobalObject::flarmnetDB()->cachedRegistration(targetID) );
             m_factorDistanceOnly.setCoordinate(Positioning::PositionProvider::lastValidCoordinate());
             m_factorDistanceOnly.setID(targetID);
             m_factorDistanceOnly.setHDist(hDist);
@@ -321,25 +321,30 @@ void Traffic::TrafficDataSource_Abstract::processFLARMSentence(QString sentence)
         // From now on, we assume that we have a directional target
         //
 
-        // As a first step, we obtain the target's coordinate. We take our own coordinate as a starting point.
-        auto targetCoordinate = Positioning::PositionProvider::lastValidCoordinate();
-        if (!targetCoordinate.isValid()) {
+        // As a first step, we obtain the target's coordinate. We take our own
+        // coordinate as a starting point and work in the local tangent plane.
+        auto ownShipCoordinate = Positioning::PositionProvider::lastValidCoordinate();
+        if (!ownShipCoordinate.isValid()) {
             return;
         }
         auto relativeNorth = arguments[1].toDouble(&ok);
         if (!ok) {
             return;
         }
-        targetCoordinate = targetCoordinate.atDistanceAndAzimuth(relativeNorth, 0);
         auto relativeEast = arguments[2].toDouble(&ok);
         if (!ok) {
             return;
         }
-        targetCoordinate = targetCoordinate.atDistanceAndAzimuth(relativeEast, 90);
+        m_localTangentPlane.refresh(ownShipCoordinate);
+        auto ownShip = m_localTangentPlane.toENU(ownShipCoordinate);
+        auto target = ownShip;
+        target.north += relativeNorth;
+        target.east += relativeEast;
         if (vDist.isFinite()) {
-            targetCoordinate = targetCoordinate.atDistanceAndAzimuth(0, 0, vDist.toM());
+            target.up += vDist.toM();
         }
-        auto hDist = Units::Distance::fromM(sqrt(relativeNorth*relativeNorth+relativeEast*relativeEast));
+        auto targetCoordinate = m_localTangentPlane.toCoordinate(target);
+        auto hDist = Positioning::LocalTangentPlane::hDist(ownShip, target);
 
         // Construct a PositionInfo object that contains additional information (such as ground speed, if available)
         QGeoPositionInfo pInfo(targetCoordinate, QDateTime::currentDateTimeUtc());
@@ -358,13 +363,14 @@ void Traffic::TrafficDataSource_Abstract::processFLARMSentence(QString sentence)
 
         // Construct a traffic object
         m_factor.setAlarmLevel(alarmLevel);
-        m_factor.setCallSign( GlobalObject::flarmnetDB()->getRegistration(targetID) );
+        m_factor.setCallSign( GlobalObject::flarmnetDB()->cachedRegistration(targetID) );
         m_factor.setHDist(hDist);
         m_factor.setID(targetID);
         m_factor.setPositionInfo( Positioning::PositionInfo(pInfo) );
         m_factor.setType(type);
         m_factor.setVDist(vDist);
         m_factor.startLiveTime();
+        stampDecoded();
         emit factorWithPosition(m_factor);
         return;
     }
@@ -559,6 +565,7 @@ void Traffic::TrafficDataSource_Abstract::processFLARMSentence(QString sentence)
         auto RelativeDistance = arguments[8];
 
         auto wrning = Traffic::Warning(AlarmLevel, RelativeBearing, AlarmType, RelativeVertical, RelativeDistance);
+        stampDecoded();
         emit warning(wrning);
 
         return;
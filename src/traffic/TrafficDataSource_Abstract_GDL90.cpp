@@ -169,7 +169,7 @@ auto pInfoFromOwnshipReport(const QByteArray &decodedData) -> QGeoPositionInfo
 
 // Member functions
 
-void Traffic::TrafficDataSource_Abstract::processGDLMessage(const QByteArray& rawMessage)
+void Traffic::TrafficDataSource_Abstract::processGDLMessage(QByteArrayView rawMessage)
 {
 
     //
@@ -188,7 +188,7 @@ void Traffic::TrafficDataSource_Abstract::processGDLMessage(const QByteArray& ra
     {
         message.reserve(rawMessage.size());
         bool isEscaped = false;
-        foreach(auto byte, rawMessage) {
+        for(auto byte : rawMessage) {
             if (byte == 0x7d) {
                 isEscaped = true;
                 continue;
@@ -327,12 +327,16 @@ void Traffic::TrafficDataSource_Abstract::processGDLMessage(const QByteArray& ra
             return;
         }
 
-        // Get ID
+        // Get ID. This is the address type, as one hex digit, followed by the
+        // 24-bit participant address, as six uppercase hex digits. For ICAO
+        // addresses, the last six digits agree with the ID reported by FLARM
+        // devices.
         auto id0 = static_cast<quint8>(message.at(0)) & 0x0FU;
         auto id1 = static_cast<quint8>(message.at(1));
         auto id2 = static_cast<quint8>(message.at(2));
         auto id3 = static_cast<quint8>(message.at(3));
-        auto id = QString::number(id0, 16) + QString::number(id1, 16) + QString::number(id2, 16) + QString::number(id3, 16);
+        auto address = (static_cast<quint32>(id1) << 16U) | (static_cast<quint32>(id2) << 8U) | id3;
+        auto id = QStringLiteral("%1%2").arg(id0, 1, 16).arg(address, 6, 16, QLatin1Char('0')).toUpper();
 
         // Alert
         auto s0 = static_cast<quint8>(message.at(0)) >> 4;
@@ -403,7 +407,8 @@ void Traffic::TrafficDataSource_Abstract::processGDLMessage(const QByteArray& ra
             auto ownShipCoordinate = positionProviderPtr->positionInfo().coordinate();
             auto trafficCoordinate = pInfo.coordinate();
             if (ownShipCoordinate.isValid() && trafficCoordinate.isValid()) {
-                hDist = Units::Distance::fromM( ownShipCoordinate.distanceTo(trafficCoordinate) );
+                m_localTangentPlane.refresh(ownShipCoordinate);
+                hDist = m_localTangentPlane.hDist(ownShipCoordinate, trafficCoordinate);
             }
         }
 
@@ -430,6 +435,7 @@ void Traffic::TrafficDataSource_Abstract::processGDLMessage(const QByteArray& ra
             m_factor.setType(type);
             m_factor.setVDist(vDist);
             m_factor.startLiveTime();
+            stampDecoded();
             emit factorWithPosition(m_factor);
         }
     }
@@ -18,48 +18,98 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <array>
+#include <charconv>
+
 #include "GlobalObject.h"
 #include "positioning/PositionProvider.h"
 #include "traffic/TrafficDataSource_Abstract.h"
 
 
+// Static Helper functions
+
+// Maximal number of comma-separated fields in an XGPS/XTRA string
+const qsizetype maxXGPSFields = 10;
+
+// Splits the string at commas. Returns the number of fields, or -1 if there
+// are more than maxXGPSFields fields. The fields point into the string.
+auto splitXGPSFields(QByteArrayView data, std::array<QByteArrayView, maxXGPSFields>& fields) -> qsizetype
+{
+    qsizetype numFields = 0;
+    qsizetype start = 0;
+    while (true) {
+        if (numFields == maxXGPSFields) {
+            return -1;
+        }
+        auto end = data.indexOf(',', start);
+        if (end < 0) {
+            fields[numFields++] = data.sliced(start);
+            return numFields;
+        }
+        fields[numFields++] = data.sliced(start, end-start);
+        start = end+1;
+    }
+}
+
+// Parses a field as a floating point number. Leading and trailing whitespace
+// is ignored, as is a leading '+' sign. Returns false if the field does not
+// contain a number.
+auto parseXGPSNumber(QByteArrayView field, double& value) -> bool
+{
+    field = field.trimmed();
+    if (field.isEmpty()) {
+        return false;
+    }
+#if defined(__cpp_lib_to_chars)
+    // std::from_chars does not accept a leading '+', but strtod and
+    // QByteArray::toDouble do
+    if (field.startsWith('+')) {
+        field = field.sliced(1);
+        if (field.isEmpty() || field.startsWith('-') || field.startsWith('+')) {
+            return false;
+        }
+    }
+    const auto* last = field.data()+field.size();
+    auto [ptr, errorCode] = std::from_chars(field.data(), last, value);
+    return (errorCode == std::errc()) && (ptr == last);
+#else
+    // Some standard libraries do not implement std::from_chars for floating
+    // point numbers. Fall back to Qt, still without copying the data.
+    bool ok = false;
+    value = QByteArray::fromRawData(field.data(), field.size()).toDouble(&ok);
+    return ok;
+#endif
+}
+
+
 // Member functions
 
-void Traffic::TrafficDataSource_Abstract::processXGPSString(const QByteArray& data)
+void Traffic::TrafficDataSource_Abstract::processXGPSString(QByteArrayView data)
 {
 
     //
     // Handle the various message types
     //
 
+    std::array<QByteArrayView, maxXGPSFields> fields;
+
     // Ownship report, serves also as heartbeat message
     if (data.startsWith("XGPS")) {
 
-        QString str = QString::fromLatin1(data);
-        QStringList list = str.split(QLatin1Char(','));
-        if (list.size() != 6) {
+        if (splitXGPSFields(data, fields) != 6) {
             return;
         }
 
-        bool ok = false;
-        double lon = list[1].toDouble(&ok);
-        if (!ok) {
-            return;
-        }
-        double lat = list[2].toDouble(&ok);
-        if (!ok) {
-            return;
-        }
-        double alt = list[3].toDouble(&ok);
-        if (!ok) {
-            return;
-        }
-        double tt = list[4].toDouble(&ok);
-        if (!ok) {
-            return;
-        }
-        double gs = list[5].toDouble(&ok);
-        if (!ok) {
+        double lon = 0.0;
+        double lat = 0.0;
+        double alt = 0.0;
+        double tt = 0.0;
+        double gs = 0.0;
+        if (!parseXGPSNumber(fields[1], lon)
+            || !parseXGPSNumber(fields[2], lat)
+            || !parseXGPSNumber(fields[3], alt)
+            || !parseXGPSNumber(fields[4], tt)
+            || !parseXGPSNumber(fields[5], gs)) {
             return;
         }
 
@@ -80,39 +130,27 @@ void Traffic::TrafficDataSource_Abstract::processXGPSString(const QByteArray& da
     // Traffic report
     if (data.startsWith("XTRA")) {
 
-        QString str = QString::fromLatin1(data);
-        QStringList list = str.split(QLatin1Char(','));
-        if (list.size() != 10) {
+        if (splitXGPSFields(data, fields) != 10) {
             return;
         }
 
-        bool ok = false;
-        QString targetID = list[1];
-        double lat = list[2].toDouble(&ok);
-        if (!ok) {
-            return;
-        }
-        double lon = list[3].toDouble(&ok);
-        if (!ok) {
-            return;
-        }
-        auto alt = Units::Distance::fromFT(list[4].toDouble(&ok));
-        if (!ok) {
-            return;
-        }
-        auto vSpeed = Units::Speed::fromFPM(list[5].toDouble(&ok));
-        if (!ok) {
-            return;
-        }
-        double tt = list[7].toDouble(&ok);
-        if (!ok) {
-            return;
-        }
-        auto hSpeed = Units::Speed::fromKN(list[8].toDouble(&ok));
-        if (!ok) {
+        double lat = 0.0;
+        double lon = 0.0;
+        double altFT = 0.0;
+        double vSpeedFPM = 0.0;
+        double tt = 0.0;
+        double hSpeedKN = 0.0;
+        if (!parseXGPSNumber(fields[2], lat)
+            || !parseXGPSNumber(fields[3], lon)
+            || !parseXGPSNumber(fields[4], altFT)
+            || !parseXGPSNumber(fields[5], vSpeedFPM)
+            || !parseXGPSNumber(fields[7], tt)
+            || !parseXGPSNumber(fields[8], hSpeedKN)) {
             return;
         }
-        auto callsign = list[9].simplified();
+        auto alt = Units::Distance::fromFT(altFT);
+        auto vSpeed = Units::Speed::fromFPM(vSpeedFPM);
+        auto hSpeed = Units::Speed::fromKN(hSpeedKN);
 
         auto trafficCoordinate = QGeoCoordinate(lat, lon, alt.toM());
         if (!trafficCoordinate.isValid()) {
@@ -134,19 +172,21 @@ void Traffic::TrafficDataSource_Abstract::processXGPSString(const QByteArray& da
         if (positionProviderPtr != nullptr) {
             auto ownShipCoordinate = positionProviderPtr->positionInfo().coordinate();
             if (ownShipCoordinate.isValid()) {
-                hDist = Units::Distance::fromM( ownShipCoordinate.distanceTo(trafficCoordinate) );
+                m_localTangentPlane.refresh(ownShipCoordinate);
+                hDist = m_localTangentPlane.hDist(ownShipCoordinate, trafficCoordinate);
                 vDist = alt - Units::Distance::fromM(ownShipCoordinate.altitude());
             }
         }
 
         m_factor.setAlarmLevel(0);
-        m_factor.setCallSign(callsign);
+        m_factor.setCallSign(QString::fromLatin1(fields[9]).simplified());
         m_factor.setHDist(hDist);
-        m_factor.setID(targetID);
+        m_factor.setID(QString::fromLatin1(fields[1]));
         m_factor.setPositionInfo( Positioning::PositionInfo(geoPositionInfo) );
         m_factor.setType(Traffic::TrafficFactor_Abstract::unknown);
         m_factor.setVDist(vDist);
         m_factor.startLiveTime();
+        stampDecoded();
         emit factorWithPosition(m_factor);
         return;
     }
@@ -18,6 +18,7 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <QDebug>
 #include <QRegExp>
 
 #include "traffic/TrafficDataSource_File.h"
@@ -48,10 +49,18 @@ void Traffic::TrafficDataSource_File::connectToTrafficReceiver()
     // Open the file
     simulatorFile.unsetError();
     if (simulatorFile.open(QIODevice::ReadOnly)) {
+        if (Traffic::TrafficCapture::isCaptureFile(simulatorFile.fileName())) {
+            m_captureRecords = Traffic::TrafficCapture::readRecords(simulatorFile.fileName());
+        }
+        m_captureIndex = 0;
         simulatorTextStream.setDevice(&simulatorFile);
         simulatorTextStream.setEncoding(QStringConverter::Latin1);
         lastPayload = QString();
         lastTime = 0;
+        m_numMessages = 0;
+        m_readNSecs = 0;
+        m_processNSecs = 0;
+        m_replayTimer.start();
         readFromSimulatorStream();
     }
 
@@ -62,6 +71,10 @@ void Traffic::TrafficDataSource_File::connectToTrafficReceiver()
 
 auto Traffic::TrafficDataSource_File::containsFLARMSimulationData(const QString& fileName) -> bool
 {
+    if (Traffic::TrafficCapture::isCaptureFile(fileName)) {
+        return true;
+    }
+
     QFile inFile(fileName);
 
     if (!inFile.open(QIODevice::ReadOnly)) {
@@ -93,6 +106,8 @@ void Traffic::TrafficDataSource_File::disconnectFromTrafficReceiver()
     // Stop any simulation that might be running
     simulatorFile.close();
     simulatorTimer.stop();
+    m_captureRecords.clear();
+    m_captureIndex = 0;
 
     // Update properties
     setReceivingHeartbeat(false);
@@ -100,26 +115,107 @@ void Traffic::TrafficDataSource_File::disconnectFromTrafficReceiver()
 }
 
 
+void Traffic::TrafficDataSource_File::finishReplay()
+{
+    auto elapsedMSecs = m_replayTimer.elapsed();
+    auto messagesPerSecond = (elapsedMSecs > 0) ? (1000.0*static_cast<double>(m_numMessages))/static_cast<double>(elapsedMSecs) : qQNaN();
+    qInfo() << "Replay of" << simulatorFile.fileName() << "finished:"
+            << m_numMessages << "messages in" << elapsedMSecs << "ms,"
+            << messagesPerSecond << "messages/s;"
+            << "reading" << m_readNSecs/1000000 << "ms,"
+            << "processing" << m_processNSecs/1000000 << "ms";
+
+    disconnectFromTrafficReceiver();
+}
+
+
+void Traffic::TrafficDataSource_File::processCaptureRecord(const Traffic::TrafficCapture::Record& record)
+{
+    stampReceived();
+    if (record.transport == Traffic::TrafficCapture::UDP) {
+        // Detect duplicates by the time stamps of the capture, in
+        // microseconds, not by the time of replay
+        processDatagram(record.data, record.timeStamp/1000);
+        return;
+    }
+
+    // TrafficDataSource_Tcp reads data with a QTextStream, line by line. We do
+    // the same here, so that the parser sees exactly the same sentences.
+    QTextStream stream(record.data);
+    stream.setEncoding(QStringConverter::Latin1);
+    QString sentence;
+    while(stream.readLineInto(&sentence)) {
+        processFLARMSentence(sentence);
+    }
+}
+
+
+void Traffic::TrafficDataSource_File::readFromCapture()
+{
+    QElapsedTimer stageTimer;
+    auto numRecords = m_unthrottled ? unthrottledChunkSize : 1;
+    for(int i=0; i<numRecords; i++) {
+        if (m_captureIndex >= m_captureRecords.size()) {
+            finishReplay();
+            return;
+        }
+        stageTimer.start();
+        processCaptureRecord(m_captureRecords.at(m_captureIndex));
+        m_processNSecs += stageTimer.nsecsElapsed();
+        m_numMessages++;
+        m_captureIndex++;
+    }
+
+    if (m_captureIndex >= m_captureRecords.size()) {
+        finishReplay();
+        return;
+    }
+    if (m_unthrottled) {
+        simulatorTimer.setInterval(0);
+    } else {
+        auto deltaUSecs = m_captureRecords.at(m_captureIndex).timeStamp - m_captureRecords.at(m_captureIndex-1).timeStamp;
+        simulatorTimer.setInterval(qMax(0, qRound(static_cast<double>(deltaUSecs)/(1000.0*m_replaySpeed))));
+    }
+    simulatorTimer.start();
+}
+
+
 void Traffic::TrafficDataSource_File::readFromSimulatorStream()
 {
+    if (!m_captureRecords.isEmpty()) {
+        readFromCapture();
+        return;
+    }
+    if (m_unthrottled) {
+        readFromSimulatorStreamUnthrottled();
+        return;
+    }
+
     if ((simulatorFile.error() != QFileDevice::NoError) || simulatorTextStream.atEnd()) {
-        disconnectFromTrafficReceiver();
+        finishReplay();
         return;
     }
 
+    QElapsedTimer stageTimer;
     if (!lastPayload.isEmpty()) {
+        stageTimer.start();
+        stampReceived();
         processFLARMSentence(lastPayload);
+        m_processNSecs += stageTimer.nsecsElapsed();
+        m_numMessages++;
     }
 
     // Read line
+    stageTimer.start();
     QString line;
     if (!simulatorTextStream.readLineInto(&line)) {
-        disconnectFromTrafficReceiver();
+        finishReplay();
         return;
     }
 
     // Set lastPayload, set timer
     auto tuple = line.split(QStringLiteral(" "));
+    m_readNSecs += stageTimer.nsecsElapsed();
     if (tuple.length() < 2) {
         return;
     }
@@ -129,13 +225,52 @@ void Traffic::TrafficDataSource_File::readFromSimulatorStream()
     if (lastTime == 0) {
         simulatorTimer.setInterval(0);
     } else {
-        simulatorTimer.setInterval(time-lastTime);
+        simulatorTimer.setInterval(qRound((time-lastTime)/m_replaySpeed));
     }
     simulatorTimer.start();
     lastTime = time;
 }
 
 
+void Traffic::TrafficDataSource_File::readFromSimulatorStreamUnthrottled()
+{
+    QElapsedTimer stageTimer;
+    QString line;
+    for(int i=0; i<unthrottledChunkSize; i++) {
+        // Read line
+        stageTimer.start();
+        if ((simulatorFile.error() != QFileDevice::NoError) || !simulatorTextStream.readLineInto(&line)) {
+            finishReplay();
+            return;
+        }
+        auto tuple = line.split(QStringLiteral(" "));
+        m_readNSecs += stageTimer.nsecsElapsed();
+        if (tuple.length() < 2) {
+            continue;
+        }
+
+        // Process line
+        stageTimer.start();
+        processFLARMSentence(tuple[1]);
+        m_processNSecs += stageTimer.nsecsElapsed();
+        m_numMessages++;
+    }
+
+    // Continue with the next chunk as soon as the event loop is idle
+    simulatorTimer.setInterval(0);
+    simulatorTimer.start();
+}
+
+
+void Traffic::TrafficDataSource_File::setReplaySpeed(double factor)
+{
+    if (!qIsFinite(factor) || (factor <= 0.0)) {
+        return;
+    }
+    m_replaySpeed = factor;
+}
+
+
 void Traffic::TrafficDataSource_File::updateProperties()
 {
     // Set new value: connectivityStatus
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QFile>
 #include <QTextStream>
 
@@ -32,6 +33,16 @@ namespace Traffic {
  *
  *  For testing purposes, this class connects to a simulator file with time
  *  stamps and FLARM/NMEA sentences, as provided by FLARM Inc.
+ *
+ *  By default, the file is replayed in real time. For benchmarking, the replay
+ *  can be sped up by a constant factor, or run unthrottled, pushing the file
+ *  through processFLARMSentence as fast as possible.  Once the end of the file
+ *  is reached, the class logs the number of messages processed, the message
+ *  rate and the time spent reading and processing the data.
+ *
+ *  The class can also replay capture files written by TrafficCapture. Raw
+ *  data found in the capture is passed through the same parsers as data
+ *  received via TCP or UDP, with the original timing.
  */
 class TrafficDataSource_File : public TrafficDataSource_Abstract {
     Q_OBJECT
@@ -52,7 +63,8 @@ public:
      *
      *  @param fileName Name of the file to be checked
      *
-     *  @returns True if the file is likely to contain FLARM simulation data
+     *  @returns True if the file is likely to contain FLARM simulation data,
+     *  or if the file is a capture file written by TrafficCapture
      */
     static auto containsFLARMSimulationData(const QString& fileName) -> bool;
 
@@ -68,6 +80,34 @@ public:
         return tr("Simulator file %1").arg(simulatorFile.fileName());
     }
 
+    /*! \brief Set replay speed
+     *
+     *  The time stamps found in the simulator file are divided by this factor.
+     *  A value of 2.0 will therefore replay the file at twice the real speed.
+     *  Non-positive or non-finite values are ignored. The default value is
+     *  1.0.
+     *
+     *  @param factor Replay speed factor
+     */
+    void setReplaySpeed(double factor);
+
+    /*! \brief Replay file as fast as possible
+     *
+     *  If set to true, the time stamps found in the simulator file are ignored
+     *  and the file is pushed through the FLARM parser as fast as possible, in
+     *  chunks of unthrottledChunkSize lines per event loop iteration.  This
+     *  setting takes precedence over the replay speed.
+     *
+     *  @param unthrottled Boolean
+     */
+    void setUnthrottled(bool unthrottled)
+    {
+        m_unthrottled = unthrottled;
+    }
+
+    /*! \brief Number of lines processed per event loop iteration in unthrottled mode */
+    static constexpr int unthrottledChunkSize = 1000;
+
 public slots:
     /*! \brief Start attempt to connect to traffic receiver
      *
@@ -89,10 +129,27 @@ private slots:
     // time.
     void readFromSimulatorStream();
 
+    // Read up to unthrottledChunkSize lines from the simulator file's text
+    // stream and pass them on to processFLARMMessage.  Sets up the timer to
+    // read the next chunk as soon as control returns to the event loop.
+    void readFromSimulatorStreamUnthrottled();
+
     // Update the properties "errorString" and "connectivityStatus".
     void updateProperties();
 
 private:
+    // Pass raw data from one capture record on to the appropriate parser
+    void processCaptureRecord(const Traffic::TrafficCapture::Record& record);
+
+    // Process one record from the capture, or up to unthrottledChunkSize
+    // records in unthrottled mode. Sets up a timer to process the next record
+    // in due time.
+    void readFromCapture();
+
+    // Log replay statistics and disconnect.  This method is called once the
+    // end of the simulator file is reached.
+    void finishReplay();
+
     QTextStream textStream;
 
     // Simulator related members
@@ -101,6 +158,20 @@ private:
     QTimer simulatorTimer;
     int lastTime {0};
     QString lastPayload;
+
+    // Capture related members
+    QVector<Traffic::TrafficCapture::Record> m_captureRecords;
+    qsizetype m_captureIndex {0};
+
+    // Replay settings
+    double m_replaySpeed {1.0};
+    bool m_unthrottled {false};
+
+    // Replay statistics
+    QElapsedTimer m_replayTimer;
+    qint64 m_numMessages {0};
+    qint64 m_readNSecs {0};
+    qint64 m_processNSecs {0};
 };
 
 } // namespace Traffic
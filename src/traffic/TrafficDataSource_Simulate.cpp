@@ -19,9 +19,170 @@
  ***************************************************************************/
 
 
+#include <QtMath>
+
+#include "positioning/Geoid.h"
 #include "traffic/TrafficDataSource_Simulate.h"
 
 
+// Static Helper functions
+
+// Meters per degree of latitude, on a spherical earth
+const double metersPerDegree = 111195.0;
+
+auto flarmTypeCode(Traffic::TrafficFactor_Abstract::AircraftType type) -> QString
+{
+    switch(type) {
+    case Traffic::TrafficFactor_Abstract::Glider:
+        return QStringLiteral("1");
+    case Traffic::TrafficFactor_Abstract::TowPlane:
+        return QStringLiteral("2");
+    case Traffic::TrafficFactor_Abstract::Copter:
+        return QStringLiteral("3");
+    case Traffic::TrafficFactor_Abstract::Skydiver:
+        return QStringLiteral("4");
+    case Traffic::TrafficFactor_Abstract::HangGlider:
+        return QStringLiteral("6");
+    case Traffic::TrafficFactor_Abstract::Paraglider:
+        return QStringLiteral("7");
+    case Traffic::TrafficFactor_Abstract::Aircraft:
+        return QStringLiteral("8");
+    case Traffic::TrafficFactor_Abstract::Jet:
+        return QStringLiteral("9");
+    case Traffic::TrafficFactor_Abstract::Balloon:
+        return QStringLiteral("B");
+    case Traffic::TrafficFactor_Abstract::Airship:
+        return QStringLiteral("C");
+    case Traffic::TrafficFactor_Abstract::Drone:
+        return QStringLiteral("D");
+    default:
+        return QStringLiteral("0");
+    }
+}
+
+auto gdl90EmitterCategory(Traffic::TrafficFactor_Abstract::AircraftType type) -> quint8
+{
+    switch(type) {
+    case Traffic::TrafficFactor_Abstract::Aircraft:
+    case Traffic::TrafficFactor_Abstract::TowPlane:
+        return 1;
+    case Traffic::TrafficFactor_Abstract::Jet:
+        return 6;
+    case Traffic::TrafficFactor_Abstract::Copter:
+        return 7;
+    case Traffic::TrafficFactor_Abstract::Glider:
+    case Traffic::TrafficFactor_Abstract::HangGlider:
+    case Traffic::TrafficFactor_Abstract::Paraglider:
+        return 9;
+    case Traffic::TrafficFactor_Abstract::Balloon:
+    case Traffic::TrafficFactor_Abstract::Airship:
+        return 10;
+    case Traffic::TrafficFactor_Abstract::Skydiver:
+        return 11;
+    case Traffic::TrafficFactor_Abstract::Drone:
+        return 14;
+    default:
+        return 0;
+    }
+}
+
+// Encodes a FLARM/NMEA sentence, adding the leading dollar sign and the checksum
+auto encodeNMEA(const QString& body) -> QString
+{
+    quint8 checksum = 0;
+    for(auto character : body) {
+        checksum ^= static_cast<quint8>(character.toLatin1());
+    }
+    return QStringLiteral("$%1*%2").arg(body).arg(checksum, 2, 16, QLatin1Char('0')).toUpper();
+}
+
+// Appends a 24bit signed latitude or longitude in GDL90 semicircle format
+void appendGDL90Angle(QByteArray& message, double angleInDEG)
+{
+    auto value = static_cast<qint32>(qRound(angleInDEG*0x800000/180.0)) & 0xFFFFFF;
+    message.append(static_cast<char>((value >> 16) & 0xFF));
+    message.append(static_cast<char>((value >> 8) & 0xFF));
+    message.append(static_cast<char>(value & 0xFF));
+}
+
+// Encodes a GDL90 ownship or traffic report (without message ID)
+auto encodeGDL90Report(int alert, quint32 address, const QGeoCoordinate& coordinate, Units::Distance pressureAltitude,
+                       Units::Speed groundSpeed, Units::Speed verticalSpeed, double trackDEG, quint8 emitterCategory,
+                       const QString& callSign) -> QByteArray
+{
+    QByteArray message;
+    message.reserve(27);
+
+    // Alert status and address type (ADS-B with ICAO address)
+    message.append(static_cast<char>((alert & 0x0F) << 4));
+    message.append(static_cast<char>((address >> 16) & 0xFF));
+    message.append(static_cast<char>((address >> 8) & 0xFF));
+    message.append(static_cast<char>(address & 0xFF));
+
+    // Position
+    appendGDL90Angle(message, coordinate.latitude());
+    appendGDL90Angle(message, coordinate.longitude());
+
+    // Pressure altitude in steps of 25ft, miscellaneous indicators (airborne, true track)
+    quint32 ddd = 0xFFF;
+    if (pressureAltitude.isFinite()) {
+        ddd = qBound(0, qRound((pressureAltitude.toFeet()+1000.0)/25.0), 0xFFE);
+    }
+    message.append(static_cast<char>(ddd >> 4));
+    message.append(static_cast<char>(((ddd & 0x0F) << 4) | 0x09));
+
+    // Navigation integrity and accuracy
+    message.append(static_cast<char>(0x8A));
+
+    // Horizontal velocity in kt, vertical velocity in steps of 64fpm
+    quint32 hhh = qBound(0, qRound(groundSpeed.toKN()), 0xFFE);
+    quint32 vvv = static_cast<quint32>(qBound(-510, qRound(verticalSpeed.toFPM()/64.0), 510)) & 0xFFF;
+    message.append(static_cast<char>(hhh >> 4));
+    message.append(static_cast<char>(((hhh & 0x0F) << 4) | (vvv >> 8)));
+    message.append(static_cast<char>(vvv & 0xFF));
+
+    // Track, emitter category, call sign, emergency/priority code
+    message.append(static_cast<char>(qRound(trackDEG*256.0/360.0) & 0xFF));
+    message.append(static_cast<char>(emitterCategory));
+    message.append(callSign.leftJustified(8, QLatin1Char(' '), true).toLatin1());
+    message.append('\0');
+
+    return message;
+}
+
+// Frames a GDL90 message: adds message ID and CRC, and applies escaping. The
+// result does not contain the 0x7e flag bytes.
+auto frameGDL90Message(quint8 messageID, const QByteArray& payload) -> QByteArray
+{
+    QByteArray message;
+    message.reserve(payload.size()+3);
+    message.append(static_cast<char>(messageID));
+    message.append(payload);
+
+    quint16 crc = 0;
+    for(auto byte : message) {
+        crc ^= static_cast<quint16>(static_cast<quint8>(byte) << 8U);
+        for(int i=0; i<8; i++) {
+            crc = ((crc & 0x8000U) != 0) ? static_cast<quint16>((crc << 1U) ^ 0x1021U) : static_cast<quint16>(crc << 1U);
+        }
+    }
+    message.append(static_cast<char>(crc & 0xFFU));
+    message.append(static_cast<char>(crc >> 8U));
+
+    QByteArray result;
+    result.reserve(message.size()+8);
+    for(auto byte : message) {
+        if ((byte == 0x7d) || (byte == 0x7e)) {
+            result.append(static_cast<char>(0x7d));
+            result.append(static_cast<char>(static_cast<quint8>(byte) ^ 0x20U));
+            continue;
+        }
+        result.append(byte);
+    }
+    return result;
+}
+
+
 // Member functions
 
 Traffic::TrafficDataSource_Simulate::TrafficDataSource_Simulate(QObject *parent) :
@@ -58,6 +219,21 @@ void Traffic::TrafficDataSource_Simulate::disconnectFromTrafficReceiver()
 
 void Traffic::TrafficDataSource_Simulate::sendSimulatorData()
 {
+    // Simulated data counts as received now
+    stampReceived();
+
+    // With synthetic traffic, ownship moves along its track, so that the
+    // position agrees with the ground speed used for relative motion and
+    // alarms
+    if (!syntheticTargets.isEmpty() && geoInfo.isValid()
+        && geoInfo.hasAttribute(QGeoPositionInfo::GroundSpeed) && geoInfo.hasAttribute(QGeoPositionInfo::Direction)) {
+        auto deltaT = std::chrono::duration<double>(simulatorTimer.intervalAsDuration()).count();
+        auto distance = geoInfo.attribute(QGeoPositionInfo::GroundSpeed)*deltaT;
+        auto azimuth = geoInfo.attribute(QGeoPositionInfo::Direction);
+        if (qIsFinite(distance) && qIsFinite(azimuth)) {
+            geoInfo.setCoordinate(geoInfo.coordinate().atDistanceAndAzimuth(distance, azimuth));
+        }
+    }
 
     geoInfo.setTimestamp( QDateTime::currentDateTimeUtc() );
     if (geoInfo.isValid()) {
@@ -83,4 +259,213 @@ void Traffic::TrafficDataSource_Simulate::sendSimulatorData()
     }
 
     emit pressureAltitudeUpdated(barometricHeight);
+
+    sendSyntheticTraffic();
+}
+
+
+void Traffic::TrafficDataSource_Simulate::sendSyntheticTraffic()
+{
+    if (syntheticTargets.isEmpty()) {
+        return;
+    }
+
+    auto ownship = geoInfo.coordinate();
+    if (!ownship.isValid() || !syntheticAnchor.isValid()) {
+        return;
+    }
+
+    // Ownship position and velocity in the local frame of syntheticAnchor
+    auto metersPerDegreeLon = metersPerDegree*qCos(qDegreesToRadians(syntheticAnchor.latitude()));
+    auto ownNorth = (ownship.latitude()-syntheticAnchor.latitude())*metersPerDegree;
+    auto ownEast = (ownship.longitude()-syntheticAnchor.longitude())*metersPerDegreeLon;
+    double ownVNorth = 0.0;
+    double ownVEast = 0.0;
+    if (geoInfo.hasAttribute(QGeoPositionInfo::GroundSpeed) && geoInfo.hasAttribute(QGeoPositionInfo::Direction)) {
+        auto ownGS = geoInfo.attribute(QGeoPositionInfo::GroundSpeed);
+        auto ownTT = qDegreesToRadians(geoInfo.attribute(QGeoPositionInfo::Direction));
+        ownVNorth = ownGS*qCos(ownTT);
+        ownVEast = ownGS*qSin(ownTT);
+    }
+    auto ownPressureAltitude = barometricHeight;
+    if (!ownPressureAltitude.isFinite() && qIsFinite(ownship.altitude())) {
+        ownPressureAltitude = Units::Distance::fromM(ownship.altitude());
+    }
+
+    // Send GDL90 geometric altitude and ownship report, so that vertical
+    // distances of GDL90 targets can be computed
+    if (qIsFinite(ownship.altitude())) {
+        auto ellipsoidalAltitude = Units::Distance::fromM(ownship.altitude());
+        auto geoidCorrection = Positioning::Geoid::separation(ownship);
+        if (geoidCorrection.isFinite()) {
+            ellipsoidalAltitude = ellipsoidalAltitude + geoidCorrection;
+        }
+        auto dd = static_cast<quint16>(static_cast<qint16>(qRound(ellipsoidalAltitude.toFeet()/5.0)));
+        QByteArray payload;
+        payload.append(static_cast<char>(dd >> 8U));
+        payload.append(static_cast<char>(dd & 0xFFU));
+        payload.append(static_cast<char>(0x00));
+        payload.append(static_cast<char>(0x0A));
+        processGDLMessage(frameGDL90Message(11, payload));
+    }
+    processGDLMessage(frameGDL90Message(10, encodeGDL90Report(0, 0xF00000, ownship, ownPressureAltitude,
+                                                              Units::Speed::fromMPS(qSqrt(ownVNorth*ownVNorth+ownVEast*ownVEast)),
+                                                              Units::Speed::fromMPS(0.0),
+                                                              qRadiansToDegrees(qAtan2(ownVEast, ownVNorth)),
+                                                              0, QStringLiteral("OWNSHIP"))));
+
+    auto deltaT = std::chrono::duration<double>(simulatorTimer.intervalAsDuration()).count();
+    auto radius = syntheticRadius.toM();
+
+    for(auto& target : syntheticTargets) {
+
+        //
+        // Move target
+        //
+        target.trackDEG = std::fmod(target.trackDEG + target.turnRateDEGPS*deltaT + 360.0, 360.0);
+        auto trackRAD = qDegreesToRadians(target.trackDEG);
+        auto vNorth = target.groundSpeedMPS*qCos(trackRAD);
+        auto vEast = target.groundSpeedMPS*qSin(trackRAD);
+        target.north += vNorth*deltaT;
+        target.east += vEast*deltaT;
+        target.altitude += target.climbRateMPS*deltaT;
+
+        // Targets that leave the area turn back towards ownship.  Thermalling
+        // targets leave their thermal once they are 1000m above ownship.
+        auto relNorth = target.north-ownNorth;
+        auto relEast = target.east-ownEast;
+        if (relNorth*relNorth + relEast*relEast > radius*radius) {
+            target.trackDEG = std::fmod(qRadiansToDegrees(qAtan2(-relEast, -relNorth)) + syntheticRandom.bounded(90.0) - 45.0 + 360.0, 360.0);
+        }
+        if (target.altitude > 1000.0) {
+            target.turnRateDEGPS = 0.0;
+            target.climbRateMPS = -1.0;
+        }
+        if (target.altitude < -1000.0) {
+            target.turnRateDEGPS = (syntheticRandom.bounded(2) == 0) ? -12.0 : 12.0;
+            target.climbRateMPS = 2.0;
+        }
+
+        //
+        // Compute alarm level from the predicted closest point of approach
+        //
+        auto relVNorth = vNorth-ownVNorth;
+        auto relVEast = vEast-ownVEast;
+        auto relV2 = relVNorth*relVNorth + relVEast*relVEast;
+        auto tCPA = (relV2 > 0.0) ? -(relNorth*relVNorth + relEast*relVEast)/relV2 : 0.0;
+        auto dNorthCPA = relNorth + relVNorth*tCPA;
+        auto dEastCPA = relEast + relVEast*tCPA;
+        auto dVertCPA = target.altitude + target.climbRateMPS*tCPA;
+        int alarmLevel = 0;
+        if ((tCPA >= 0.0) && (tCPA <= 18.0) && (dNorthCPA*dNorthCPA + dEastCPA*dEastCPA < 150.0*150.0) && (qAbs(dVertCPA) < 150.0)) {
+            alarmLevel = (tCPA <= 8.0) ? 3 : ((tCPA <= 12.0) ? 2 : 1);
+        }
+
+        //
+        // Send target in wire format
+        //
+        QGeoCoordinate coordinate(syntheticAnchor.latitude() + target.north/metersPerDegree,
+                                  syntheticAnchor.longitude() + target.east/metersPerDegreeLon);
+        switch(target.protocol) {
+        case SyntheticTarget::GDL90:
+            processGDLMessage(frameGDL90Message(20, encodeGDL90Report((alarmLevel > 0) ? 1 : 0, target.address, coordinate,
+                                                                      ownPressureAltitude + Units::Distance::fromM(target.altitude),
+                                                                      Units::Speed::fromMPS(target.groundSpeedMPS),
+                                                                      Units::Speed::fromMPS(target.climbRateMPS),
+                                                                      target.trackDEG,
+                                                                      gdl90EmitterCategory(target.type),
+                                                                      QStringLiteral("SIM%1").arg(target.address & 0xFFFFU, 4, 16, QLatin1Char('0')).toUpper())));
+            break;
+        case SyntheticTarget::XTRA:
+            processXGPSString(QStringLiteral("XTRAFFICEnroute,%1,%2,%3,%4,%5,1,%6,%7,SIM%8")
+                              .arg(target.ID)
+                              .arg(coordinate.latitude(), 0, 'f', 6)
+                              .arg(coordinate.longitude(), 0, 'f', 6)
+                              .arg((Units::Distance::fromM(ownship.altitude()+target.altitude)).toFeet(), 0, 'f', 0)
+                              .arg(Units::Speed::fromMPS(target.climbRateMPS).toFPM(), 0, 'f', 0)
+                              .arg(target.trackDEG, 0, 'f', 1)
+                              .arg(Units::Speed::fromMPS(target.groundSpeedMPS).toKN(), 0, 'f', 1)
+                              .arg(target.address & 0xFFFFU, 4, 16, QLatin1Char('0')).toLatin1());
+            break;
+        case SyntheticTarget::FLARM:
+            processFLARMSentence(encodeNMEA(QStringLiteral("PFLAA,%1,%2,%3,%4,2,%5,%6,,%7,%8,%9")
+                                            .arg(alarmLevel)
+                                            .arg(qRound(relNorth))
+                                            .arg(qRound(relEast))
+                                            .arg(qRound(target.altitude))
+                                            .arg(target.ID)
+                                            .arg(qRound(target.trackDEG))
+                                            .arg(target.groundSpeedMPS, 0, 'f', 1)
+                                            .arg(target.climbRateMPS, 0, 'f', 1)
+                                            .arg(flarmTypeCode(target.type))));
+            break;
+        }
+    }
+}
+
+
+void Traffic::TrafficDataSource_Simulate::setSyntheticTraffic(int numTargets, Units::Distance radius, double fractionGDL90, double fractionXTRA)
+{
+    syntheticTargets.clear();
+    syntheticRadius = radius;
+    syntheticAnchor = geoInfo.coordinate();
+    if (!syntheticAnchor.isValid() || (numTargets <= 0) || !radius.isFinite()) {
+        return;
+    }
+
+    // Constant seed, so that runs are reproducible
+    syntheticRandom.seed(0x454E52);
+
+    syntheticTargets.reserve(numTargets);
+    for(int i=0; i<numTargets; i++) {
+        SyntheticTarget target;
+        target.address = 0xD00000 + static_cast<quint32>(i);
+        target.ID = QString::number(target.address, 16).toUpper();
+
+        // Uniformly distributed in a disk of the given radius
+        auto distance = radius.toM()*qSqrt(syntheticRandom.generateDouble());
+        auto bearing = syntheticRandom.bounded(2.0*M_PI);
+        target.north = distance*qCos(bearing);
+        target.east = distance*qSin(bearing);
+        target.altitude = syntheticRandom.bounded(1600.0) - 800.0;
+        target.trackDEG = syntheticRandom.bounded(360.0);
+
+        // Mostly gliders, some of them thermalling, some powered aircraft and a few others
+        auto kind = syntheticRandom.bounded(100);
+        if (kind < 70) {
+            target.type = Traffic::TrafficFactor_Abstract::Glider;
+            target.groundSpeedMPS = 22.0 + syntheticRandom.bounded(20.0);
+            if (syntheticRandom.bounded(2) == 0) {
+                target.turnRateDEGPS = (syntheticRandom.bounded(2) == 0) ? -12.0 : 12.0;
+                target.climbRateMPS = 0.5 + syntheticRandom.bounded(3.0);
+            } else {
+                target.climbRateMPS = -0.5 - syntheticRandom.bounded(1.0);
+            }
+        } else if (kind < 85) {
+            target.type = Traffic::TrafficFactor_Abstract::Aircraft;
+            target.groundSpeedMPS = 45.0 + syntheticRandom.bounded(30.0);
+            target.climbRateMPS = syntheticRandom.bounded(4.0) - 2.0;
+        } else if (kind < 90) {
+            target.type = Traffic::TrafficFactor_Abstract::TowPlane;
+            target.groundSpeedMPS = 35.0 + syntheticRandom.bounded(10.0);
+            target.climbRateMPS = 3.0;
+            target.turnRateDEGPS = syntheticRandom.bounded(2.0) - 1.0;
+        } else if (kind < 95) {
+            target.type = Traffic::TrafficFactor_Abstract::Copter;
+            target.groundSpeedMPS = 30.0 + syntheticRandom.bounded(30.0);
+        } else {
+            target.type = Traffic::TrafficFactor_Abstract::Paraglider;
+            target.groundSpeedMPS = 8.0 + syntheticRandom.bounded(5.0);
+            target.turnRateDEGPS = (syntheticRandom.bounded(2) == 0) ? -15.0 : 15.0;
+            target.climbRateMPS = syntheticRandom.bounded(3.0) - 1.0;
+        }
+
+        auto protocol = syntheticRandom.generateDouble();
+        if (protocol < fractionGDL90) {
+            target.protocol = SyntheticTarget::GDL90;
+        } else if (protocol < fractionGDL90+fractionXTRA) {
+            target.protocol = SyntheticTarget::XTRA;
+        }
+        syntheticTargets.append(target);
+    }
 }
@@ -22,6 +22,7 @@
 
 #include <QGeoPositionInfo>
 #include <QPointer>
+#include <QRandomGenerator>
 
 #include "traffic/TrafficDataSource_Abstract.h"
 
@@ -31,6 +32,12 @@ namespace Traffic {
 /*! \brief Traffic receiver: Simulator that provides constant data
  *
  *  For testing purposes, this class provides constant traffic data.
+ *
+ *  For stress testing, the class can also generate a large number of synthetic
+ *  traffic targets that move along realistic trajectories (straight legs and
+ *  thermalling circles). These targets are encoded as FLARM/NMEA sentences or
+ *  GDL90 messages and fed through the same parsers that handle data from real
+ *  traffic receivers, so that the full path from parser to GUI is exercised.
  */
 class TrafficDataSource_Simulate : public TrafficDataSource_Abstract {
     Q_OBJECT
@@ -140,12 +147,61 @@ public slots:
         trafficFactors.clear();
     }
 
+    /*! \brief Generate synthetic traffic
+     *
+     *  This method replaces all synthetic traffic by numTargets new targets,
+     *  placed at random within the given radius around the simulated ownship
+     *  position. Once per second, ownship moves along its track with its
+     *  ground speed, every target moves along its trajectory
+     *  and is reported in wire format, as a FLARM PFLAA sentence, as a GDL90
+     *  traffic report or as a ForeFlight XTRAFFIC string.  Alarm levels are assigned based on the
+     *  predicted time to closest approach.  The random number generator that
+     *  places and moves the targets is seeded with a constant, so that runs are
+     *  reproducible.
+     *
+     *  @param numTargets Number of targets. Use 0 to remove all synthetic
+     *  traffic.
+     *
+     *  @param radius Targets are kept within this distance from ownship
+     *
+     *  @param fractionGDL90 Fraction of targets that are reported in GDL90
+     *  format.
+     *
+     *  @param fractionXTRA Fraction of targets that are reported in XTRAFFIC
+     *  format. All other targets are reported in FLARM format.
+     */
+    void setSyntheticTraffic(int numTargets, Units::Distance radius = Units::Distance::fromNM(5.0), double fractionGDL90 = 0.5, double fractionXTRA = 0.0);
+
 private slots:
     // Send out simulated data. This slot will be called once per second once
     // connectToTrafficReceiver() has been called
     void sendSimulatorData();
 
 private:
+    // Synthetic traffic target. Positions are given in meters north and east
+    // of syntheticAnchor, altitudes in meters relative to ownship.
+    struct SyntheticTarget
+    {
+        quint32 address {0};
+        QString ID;
+        double north {0.0};
+        double east {0.0};
+        double altitude {0.0};
+        double trackDEG {0.0};
+        double groundSpeedMPS {0.0};
+        double climbRateMPS {0.0};
+        double turnRateDEGPS {0.0};
+        TrafficFactor_Abstract::AircraftType type {TrafficFactor_Abstract::unknown};
+        enum {
+            FLARM,
+            GDL90,
+            XTRA
+        } protocol {FLARM};
+    };
+
+    // Move synthetic targets by one timer tick and send them out in wire
+    // format
+    void sendSyntheticTraffic();
 
     // Simulator related members
     QTimer simulatorTimer;
@@ -153,6 +209,15 @@ private:
     Units::Distance barometricHeight;
     QVector<QPointer<TrafficFactor_WithPosition>> trafficFactors;
     QPointer<TrafficFactor_DistanceOnly> trafficFactor_DistanceOnly;
+
+    // Synthetic traffic
+    QVector<SyntheticTarget> syntheticTargets;
+    QGeoCoordinate syntheticAnchor;
+    Units::Distance syntheticRadius;
+
+    // Random number generator for synthetic traffic. It is seeded with a
+    // constant in setSyntheticTraffic(), so that runs are reproducible.
+    QRandomGenerator syntheticRandom;
 };
 
 } // namespace Traffic
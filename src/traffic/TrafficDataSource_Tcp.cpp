@@ -34,6 +34,16 @@ Traffic::TrafficDataSource_Tcp::TrafficDataSource_Tcp(QString hostName, quint16
     connect(&m_socket, &QTcpSocket::stateChanged, this, &Traffic::TrafficDataSource_Tcp::onStateChanged);
     connect(&m_socket, &QAbstractSocket::disconnected, this, &Traffic::TrafficDataSource_Tcp::connectToTrafficReceiver, Qt::ConnectionType::QueuedConnection);
 
+    // Fast attach
+    m_connectTimeoutTimer.setSingleShot(true);
+    m_connectTimeoutTimer.setInterval(fastAttachConnectTimeout);
+    connect(&m_connectTimeoutTimer, &QTimer::timeout, this, &Traffic::TrafficDataSource_Tcp::onConnectTimeout);
+    connect(&m_socket, &QTcpSocket::connected, &m_connectTimeoutTimer, &QTimer::stop);
+    connect(&m_socket, &QTcpSocket::errorOccurred, this, &Traffic::TrafficDataSource_Tcp::scheduleRetry);
+    m_retryTimer.setSingleShot(true);
+    connect(&m_retryTimer, &QTimer::timeout, this, &Traffic::TrafficDataSource_Tcp::connectToTrafficReceiver);
+    connect(this, &Traffic::TrafficDataSource_Abstract::receivingHeartbeatChanged, &m_retryTimer, &QTimer::stop);
+
     // Set up text stream
     m_textStream.setDevice(&m_socket);
     m_textStream.setEncoding(QStringConverter::Latin1);
@@ -72,6 +82,11 @@ void Traffic::TrafficDataSource_Tcp::connectToTrafficReceiver()
     m_socket.setSocketOption(QAbstractSocket::KeepAliveOption, 1);
     m_socket.connectToHost(m_hostName, m_port);
     m_textStream.setDevice(&m_socket);
+    m_connectTimeoutTimer.stop();
+    if (!m_fastAttachDeadline.hasExpired()
+        && ((m_socket.state() == QAbstractSocket::HostLookupState) || (m_socket.state() == QAbstractSocket::ConnectingState))) {
+        m_connectTimeoutTimer.start();
+    }
 
     // Update properties
     onStateChanged(m_socket.state());
@@ -85,6 +100,9 @@ void Traffic::TrafficDataSource_Tcp::disconnectFromTrafficReceiver()
     // Reset password lifecycle
     resetPasswordLifecycle();
 
+    // End fast attach
+    setFastAttachDeadline(QDeadlineTimer(0));
+
     // Disconnect socket.
     m_socket.abort();
 
@@ -94,8 +112,24 @@ void Traffic::TrafficDataSource_Tcp::disconnectFromTrafficReceiver()
 }
 
 
+void Traffic::TrafficDataSource_Tcp::onConnectTimeout()
+{
+    if (m_socket.state() == QAbstractSocket::ConnectedState) {
+        return;
+    }
+    m_socket.abort();
+    setErrorString( tr("The connection attempt timed out.") );
+    onStateChanged(m_socket.state());
+    scheduleRetry();
+}
+
+
 void Traffic::TrafficDataSource_Tcp::onReadyRead()
 {
+    stampReceived();
+
+    // Record raw data before the text stream consumes it
+    captureRawData(Traffic::TrafficCapture::TCP, m_port, m_socket.peek(m_socket.bytesAvailable()));
 
     QString sentence;
     while( m_textStream.readLineInto(&sentence) ) {
@@ -132,6 +166,30 @@ void Traffic::TrafficDataSource_Tcp::resetPasswordLifecycle()
 }
 
 
+void Traffic::TrafficDataSource_Tcp::scheduleRetry()
+{
+    if (m_fastAttachDeadline.hasExpired() || receivingHeartbeat() || m_retryTimer.isActive()) {
+        return;
+    }
+    if (m_socket.state() == QAbstractSocket::ConnectedState) {
+        return;
+    }
+    m_retryTimer.start(m_backoff);
+    m_backoff = qMin(2*m_backoff, std::chrono::milliseconds(fastAttachMaxBackoff));
+}
+
+
+void Traffic::TrafficDataSource_Tcp::setFastAttachDeadline(QDeadlineTimer deadline)
+{
+    m_fastAttachDeadline = deadline;
+    m_backoff = fastAttachMinBackoff;
+    if (m_fastAttachDeadline.hasExpired()) {
+        m_connectTimeoutTimer.stop();
+        m_retryTimer.stop();
+    }
+}
+
+
 void Traffic::TrafficDataSource_Tcp::setPassword(const QString& SSID, const QString& password)
 {
     if (passwordRequest_Status != waitingForPassword) {
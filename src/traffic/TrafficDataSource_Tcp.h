@@ -22,6 +22,7 @@
 
 #include <QPointer>
 #include <QTcpSocket>
+#include <QTimer>
 
 #include "traffic/TrafficDataSource_AbstractSocket.h"
 
@@ -37,6 +38,11 @@ namespace Traffic {
  *  In most use cases, the connection will be established via the device's WiFi
  *  interface.  The class will therefore try to lock the WiFi once a heartbeat
  *  has been detected, and release the WiFi at the appropriate time.
+ *
+ *  Right after joining a WiFi network, the receiver is often not yet reachable
+ *  and the first connection attempts fail or hang. During fast attach (see
+ *  setFastAttachDeadline()), connection attempts are therefore aborted after
+ *  fastAttachConnectTimeout and retried with exponential backoff.
  */
 
 class TrafficDataSource_Tcp : public TrafficDataSource_AbstractSocket {
@@ -68,6 +74,19 @@ public:
         return tr("TCP connection to %1 port %2").arg(m_hostName).arg(m_port);
     }
 
+    /*! \brief Connect timeout during fast attach */
+    static constexpr auto fastAttachConnectTimeout = 1500ms;
+
+    /*! \brief Delay before the first retry during fast attach
+     *
+     *  The delay doubles with every failed attempt, up to
+     *  fastAttachMaxBackoff.
+     */
+    static constexpr auto fastAttachMinBackoff = 250ms;
+
+    /*! \brief Maximal delay between retries during fast attach */
+    static constexpr auto fastAttachMaxBackoff = 4000ms;
+
 public slots:
     /*! \brief Start attempt to connect to traffic receiver
      *
@@ -83,6 +102,14 @@ public slots:
      */
     void disconnectFromTrafficReceiver() override;
 
+    /*! \brief Set deadline for fast attach
+     *
+     *  This method implements the virtual method declared by its superclass.
+     *
+     *  @param deadline End of fast attach
+     */
+    void setFastAttachDeadline(QDeadlineTimer deadline) override;
+
     /*! \brief Set password
      *
      *  This method implements the pure virtual method declared by its
@@ -91,10 +118,19 @@ public slots:
     void setPassword(const QString& SSID, const QString& password) override;
 
 private slots:
+    // Aborts a connection attempt that takes longer than
+    // fastAttachConnectTimeout, and schedules a retry
+    void onConnectTimeout();
+
     // Read lines from the socket's text stream and passes the string on to
     // processFLARMMessage.
     void onReadyRead();
 
+    // During fast attach, schedules a new connection attempt after the current
+    // backoff delay and doubles the delay. Does nothing if fast attach has
+    // ended, if a retry is already scheduled or if the heartbeat is received.
+    void scheduleRetry();
+
     // This method does the actual job of sending the password to the traffic
     // data receiver
     //
@@ -129,6 +165,12 @@ private:
     QString m_hostName;
     quint16 m_port;
 
+    // Fast attach
+    QDeadlineTimer m_fastAttachDeadline {0};
+    QTimer m_connectTimeoutTimer;
+    QTimer m_retryTimer;
+    std::chrono::milliseconds m_backoff {fastAttachMinBackoff};
+
 
     /* Password lifecycle
      *
@@ -18,8 +18,6 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
-#include <QNetworkDatagram>
-
 #include "traffic/TrafficDataSource_Udp.h"
 
 
@@ -100,40 +98,29 @@ void Traffic::TrafficDataSource_Udp::onReadyRead()
         return;
     }
 
-    // Read datagrams
+    // Read all pending datagrams into a buffer that is re-used across calls,
+    // so that reading does not allocate memory once the buffer has grown to
+    // the size of the largest datagram.
     while (m_socket->hasPendingDatagrams())
     {
-        QByteArray data = m_socket->receiveDatagram().data();
-
-        // Return immediately if the datagram has already been received.
-        auto currentDatagramHash = qHash(data);
-        foreach(auto hash, receivedDatagramHashes)
+        auto size = m_socket->pendingDatagramSize();
+        if (size < 0)
         {
-            if (hash == currentDatagramHash)
-            {
-                return;
-            }
+            break;
         }
-        receivedDatagramHashes[nextHashIndex] = currentDatagramHash;
-        nextHashIndex = (nextHashIndex+1) % receivedDatagramHashes.size();
-
-        // Process datagrams, depending on content type
-        if (data.startsWith("XGPS") || data.startsWith("XTRA"))
+        if (m_datagramBuffer.size() < size)
         {
-            processXGPSString(data);
+            m_datagramBuffer.resize(size);
         }
-        else
+        size = m_socket->readDatagram(m_datagramBuffer.data(), size);
+        if (size < 0)
         {
-            // Split data into raw messages
-            foreach(auto rawMessage, data.split(0x7e))
-            {
-                if (!rawMessage.isEmpty())
-                {
-                    processGDLMessage(rawMessage);
-                }
-            }
-
+            break;
         }
+        stampReceived();
+        QByteArrayView data(m_datagramBuffer.constData(), size);
+        captureRawData(Traffic::TrafficCapture::UDP, m_port, data);
+        processDatagram(data);
     }
 
 }
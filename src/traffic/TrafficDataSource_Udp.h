@@ -90,11 +90,8 @@ private:
     QPointer<QUdpSocket> m_socket;
     quint16 m_port;
 
-    // We use this vector to store the last 512 datatgram hashes in a circular
-    // array. This is used to sort out doubly sent datagrams. The nextHashIndex
-    // points to the next vector entry that will be re-written.
-    QVector<uint> receivedDatagramHashes {512, 0};
-    qsizetype nextHashIndex {0};
+    // Buffer for incoming datagrams, re-used by onReadyRead
+    QByteArray m_datagramBuffer;
 
     // GPS altitude of owncraft
     Units::Distance m_trueAltitude;
@@ -26,9 +26,6 @@
 Traffic::TrafficFactor_Abstract::TrafficFactor_Abstract(QObject* parent) : QObject(parent)
 {  
 
-    lifeTimeCounter.setSingleShot(true);
-    lifeTimeCounter.setInterval(lifeTime);
-
     // Bindings for property color
     connect(this, &Traffic::TrafficFactor_Abstract::alarmLevelChanged, this, &Traffic::TrafficFactor_Abstract::colorChanged);
 
@@ -38,72 +35,23 @@ Traffic::TrafficFactor_Abstract::TrafficFactor_Abstract(QObject* parent) : QObje
     connect(this, &Traffic::TrafficFactor_Abstract::vDistChanged, this, &Traffic::TrafficFactor_Abstract::dispatchUpdateDescription);
 
     // Bindings for property valid
-    connect(&lifeTimeCounter, &QTimer::timeout, this, &Traffic::TrafficFactor_Abstract::dispatchUpdateValid);
     connect(this, &Traffic::TrafficFactor_Abstract::alarmLevelChanged, this, &Traffic::TrafficFactor_Abstract::dispatchUpdateValid);
     connect(this, &Traffic::TrafficFactor_Abstract::hDistChanged, this, &Traffic::TrafficFactor_Abstract::dispatchUpdateValid);
 
 }
 
 
-void Traffic::TrafficFactor_Abstract::dispatchUpdateDescription()
-{
-    updateDescription();
-}
-
-
-void Traffic::TrafficFactor_Abstract::dispatchUpdateValid()
-{
-    updateValid();
-}
-
-
-auto Traffic::TrafficFactor_Abstract::hasHigherPriorityThan(const TrafficFactor_Abstract& rhs) const -> bool
-{
-
-    // Criterion 1: Valid instances have higher priority than invalid ones
-    if (!rhs.valid()) {
-        return true;
-    }
-    if (!valid()) {
-        return false;
-    }
-    // At this point, both instances are valid.
-
-    // Criterion 2: Alarm level
-    if (alarmLevel() > rhs.alarmLevel()) {
-        return true;
-    }
-    if (alarmLevel() < rhs.alarmLevel()) {
-        return false;
-    }
-    // At this point, both instances have equal alarm levels
-
-    // Final criterion: distance to current position
-    return (hDist() < rhs.hDist());
-
-}
-
-
-void Traffic::TrafficFactor_Abstract::startLiveTime()
-{
-
-    lifeTimeCounter.start();
-    updateValid();
-
-}
-
-
-void Traffic::TrafficFactor_Abstract::updateDescription()
+auto Traffic::TrafficFactor_Abstract::buildDescription() const -> QString
 {
     QStringList results;
 
     // CallSign
-    if (!callSign().isEmpty()) {
-        results << callSign();
+    if (!m_descriptionKey.callSign.isEmpty()) {
+        results << m_descriptionKey.callSign;
     }
 
     // Aircraft type
-    switch(type()) {
+    switch(m_descriptionKey.type) {
     case Aircraft:
         results << tr("Aircraft");
         break;
@@ -146,19 +94,97 @@ void Traffic::TrafficFactor_Abstract::updateDescription()
     }
 
     // Position
-    results << tr("Position unknown");
+    if (!m_descriptionKey.positionKnown) {
+        results << tr("Position unknown");
+    }
 
     // Vertical distance
+    if (m_descriptionKey.vDistKnown) {
+        // Show the vertical distance rounded to 100 ft, as stored in the key,
+        // also if the distance is shown in meters. The description changes
+        // only with the key, so any finer value would be stale.
+        auto vDistance = Units::Distance::fromFT(100.0*m_descriptionKey.vDistHundredFT);
+        QString result = GlobalObject::navigator()->aircraft().verticalDistanceToString(vDistance, true);
+        if (!m_descriptionKey.climbArrow.isNull()) {
+            result += u' ';
+            result += m_descriptionKey.climbArrow;
+        }
+        results << result;
+    }
+
+    return results.join(u"<br>");
+}
+
+
+auto Traffic::TrafficFactor_Abstract::descriptionKey() const -> DescriptionKey
+{
+    DescriptionKey key;
+    key.type = type();
+    key.callSign = callSign();
     if (vDist().isFinite()) {
-        results << GlobalObject::navigator()->aircraft().verticalDistanceToString(vDist(), true);
+        key.vDistKnown = true;
+        key.vDistHundredFT = qRound(vDist().toFeet()/100.0);
     }
+    return key;
+}
+
+
+void Traffic::TrafficFactor_Abstract::dispatchUpdateDescription()
+{
+    updateDescription();
+}
 
-    // Set property value
-    auto newDescription = results.join(u"<br>");
-    if (m_description == newDescription) {
+
+void Traffic::TrafficFactor_Abstract::dispatchUpdateValid()
+{
+    updateValid();
+}
+
+
+auto Traffic::TrafficFactor_Abstract::hasHigherPriorityThan(const TrafficFactor_Abstract& rhs) const -> bool
+{
+
+    // Criterion 1: Valid instances have higher priority than invalid ones
+    if (!rhs.valid()) {
+        return true;
+    }
+    if (!valid()) {
+        return false;
+    }
+    // At this point, both instances are valid.
+
+    // Criterion 2: Alarm level
+    if (alarmLevel() > rhs.alarmLevel()) {
+        return true;
+    }
+    if (alarmLevel() < rhs.alarmLevel()) {
+        return false;
+    }
+    // At this point, both instances have equal alarm levels
+
+    // Final criterion: distance to current position
+    return (hDist() < rhs.hDist());
+
+}
+
+
+void Traffic::TrafficFactor_Abstract::startLiveTime()
+{
+
+    m_lifeTimeDeadline.setRemainingTime(lifeTime);
+    updateValid();
+
+}
+
+
+void Traffic::TrafficFactor_Abstract::updateDescription()
+{
+    auto newDescriptionKey = descriptionKey();
+    if (m_descriptionKey == newDescriptionKey) {
         return;
     }
-    m_description = newDescription;
+    m_descriptionKey = newDescriptionKey;
+    m_descriptionDirty = true;
     emit descriptionChanged();
 }
 
@@ -173,7 +199,7 @@ void Traffic::TrafficFactor_Abstract::updateValid()
     if (m_alarmLevel > 3) {
         newValid = false;
     }
-    if (!lifeTimeCounter.isActive()) {
+    if (m_lifeTimeDeadline.hasExpired()) {
         newValid = false;
     }
     if (!hDist().isFinite()) {
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <QDeadlineTimer>
 #include <QTimer>
 #include <chrono>
 
@@ -40,6 +41,11 @@ namespace Traffic {
  *  The length of the lifetime is specified in the constant "lifeTime". You can (re)start an object's lifetime
  *  startLiveTime(). Once the lift-time of an object is expired, the property "valid" will alway contain
  *  the word "false", regardless of the object's other properties.
+ *
+ *  Instances do not run timers of their own. The expiry of the lifetime is
+ *  noticed only when the property "valid" is re-evaluated, for instance by
+ *  checkLiveTime(). The TrafficDataProvider calls this method for all of its
+ *  traffic objects from a single timing wheel.
  */
 
 class TrafficFactor_Abstract : public QObject {
@@ -120,6 +126,25 @@ public:
      */
     [[nodiscard]] auto hasHigherPriorityThan(const TrafficFactor_Abstract& rhs) const -> bool;
 
+    /*! \brief Re-evaluates the property "valid"
+     *
+     *  This method must be called after the lifetime of this object has
+     *  expired, in order to set the property "valid" to false.
+     */
+    void checkLiveTime()
+    {
+        updateValid();
+    }
+
+    /*! \brief End of the lifetime of this object
+     *
+     *  @returns Deadline at which the lifetime of this object expires
+     */
+    [[nodiscard]] auto lifeTimeDeadline() const -> QDeadlineTimer
+    {
+        return m_lifeTimeDeadline;
+    }
+
     /*! \brief Starts or extends the lifetime of this object
      *
      *  Traffic information is valantile, and is considered valid only
@@ -274,6 +299,12 @@ public:
      *  This method holds a human-readable, translated description of the
      *  traffic. This is a rich-text string of the form "Glider<br>+15 0m" or
      *  "Airship<br>Position unknown<br>-45 ft".
+     *
+     *  The string is built lazily, when the property is read. The notifier
+     *  signal is emitted only if one of the inputs that affect the text has
+     *  changed: type, call sign, vertical distance rounded to 100 ft, and the
+     *  climb arrow.  The vertical distance is shown rounded to 100 ft,
+     *  converted to meters if the aircraft uses meters for vertical distances.
      */
     Q_PROPERTY(QString description READ description NOTIFY descriptionChanged)
 
@@ -283,6 +314,10 @@ public:
      */
     [[nodiscard]] auto description() const -> QString
     {
+        if (m_descriptionDirty) {
+            m_description = buildDescription();
+            m_descriptionDirty = false;
+        }
         return m_description;
     }
 
@@ -455,14 +490,43 @@ protected:
     void dispatchUpdateValid();
     bool m_valid {false};
 
-    // Setter function for the property "description". This function is virtual and must not be
-    // called or accessed from the constructor. For this reason, we have a special function
-    // "dispatchUpdateDescription", which whose address is already known to the constructor.
-    virtual void updateDescription();
+    // Inputs that determine the text of the property "description"
+    struct DescriptionKey
+    {
+        AircraftType type {AircraftType::unknown};
+        QString callSign {};
+        bool positionKnown {false};
+        bool vDistKnown {false};
+        // Vertical distance in multiples of 100 ft. Finer changes do not
+        // change the description.
+        int vDistHundredFT {0};
+        QChar climbArrow {};
+
+        auto operator==(const DescriptionKey& other) const -> bool = default;
+    };
+
+    // Computes the inputs for the property "description". Subclasses that add
+    // information to the description override this method.
+    [[nodiscard]] virtual auto descriptionKey() const -> DescriptionKey;
+
+    // Setter function for the property "description". This function calls the
+    // virtual method descriptionKey() and must not be called or accessed from
+    // the constructor. For this reason, we have a special function
+    // "dispatchUpdateDescription", which whose address is already known to the
+    // constructor.  The function does not build the description string, but
+    // marks it for rebuild if the inputs have changed.
+    void updateDescription();
     void dispatchUpdateDescription();
-    QString m_description {};
 
 private:
+    // Builds the description string from m_descriptionKey
+    [[nodiscard]] auto buildDescription() const -> QString;
+
+    // Cache for the property "description"
+    DescriptionKey m_descriptionKey;
+    mutable QString m_description {};
+    mutable bool m_descriptionDirty {true};
+
     //
     // Property values
     //
@@ -475,9 +539,9 @@ private:
     AircraftType m_type {AircraftType::unknown};
     Units::Distance m_vDist;
 
-    // Timer for timeout. Traffic objects become invalid if their data has not been
-    // refreshed for longer than timeout.
-    QTimer lifeTimeCounter;
+    // Deadline for timeout. Traffic objects become invalid if their data has not
+    // been refreshed for longer than lifeTime. Initially expired.
+    QDeadlineTimer m_lifeTimeDeadline {0};
 };
 
 } // namespace Traffic
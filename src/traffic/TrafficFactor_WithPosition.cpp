@@ -20,8 +20,6 @@
 
 #include "GlobalObject.h"
 #include "GlobalSettings.h"
-#include "navigation/Aircraft.h"
-#include "navigation/Navigator.h"
 #include "positioning/PositionProvider.h"
 #include "traffic/TrafficFactor_WithPosition.h"
 
@@ -42,6 +40,29 @@ Traffic::TrafficFactor_WithPosition::TrafficFactor_WithPosition(QObject *parent)
 }
 
 
+auto Traffic::TrafficFactor_WithPosition::descriptionKey() const -> DescriptionKey
+{
+    auto key = TrafficFactor_Abstract::descriptionKey();
+    key.positionKnown = m_positionInfo.coordinate().isValid();
+
+    if (key.vDistKnown) {
+        auto climbRateMPS = m_positionInfo.attribute(QGeoPositionInfo::VerticalSpeed);
+        if ( qIsFinite(climbRateMPS) ) {
+            if (climbRateMPS < -1.0) {
+                key.climbArrow = u'↘';
+            }
+            if ((climbRateMPS >= -1.0) && (climbRateMPS <= +1.0)) {
+                key.climbArrow = u'→';
+            }
+            if (climbRateMPS > 1.0) {
+                key.climbArrow = u'↗';
+            }
+        }
+    }
+    return key;
+}
+
+
 void Traffic::TrafficFactor_WithPosition::setPositionInfo(const Positioning::PositionInfo& newPositionInfo)
 {
 
@@ -54,85 +75,24 @@ void Traffic::TrafficFactor_WithPosition::setPositionInfo(const Positioning::Pos
 }
 
 
-void Traffic::TrafficFactor_WithPosition::updateDescription()
+void Traffic::TrafficFactor_WithPosition::setTrail(const QList<QGeoCoordinate>& newTrail)
 {
-    QStringList results;
-
-    if (!callSign().isEmpty()) {
-        results << callSign();
-    }
-
-    switch(type()) {
-    case TrafficFactor_Abstract::Aircraft:
-        results << tr("Aircraft");
-        break;
-    case TrafficFactor_Abstract::Airship:
-        results << tr("Airship");
-        break;
-    case TrafficFactor_Abstract::Balloon:
-        results << tr("Balloon");
-        break;
-    case TrafficFactor_Abstract::Copter:
-        results << tr("Copter");
-        break;
-    case TrafficFactor_Abstract::Drone:
-        results << tr("Drone");
-        break;
-    case TrafficFactor_Abstract::Glider:
-        results << tr("Glider");
-        break;
-    case TrafficFactor_Abstract::HangGlider:
-        results << tr("Hang glider");
-        break;
-    case TrafficFactor_Abstract::Jet:
-        results << tr("Jet");
-        break;
-    case TrafficFactor_Abstract::Paraglider:
-        results << tr("Paraglider");
-        break;
-    case TrafficFactor_Abstract::Skydiver:
-        results << tr("Skydiver");
-        break;
-    case TrafficFactor_Abstract::StaticObstacle:
-        results << tr("Static Obstacle");
-        break;
-    case TrafficFactor_Abstract::TowPlane:
-        results << tr("Tow Plane");
-        break;
-    default:
-        results << tr("Traffic");
-        break;
+    if (m_trail == newTrail) {
+        return;
     }
+    m_trail = newTrail;
+    emit trailChanged();
+}
 
-    if (!positionInfo().coordinate().isValid()) {
-        results << tr("Position unknown");
-    }
 
-    if (vDist().isFinite()) {       
-        QString result = GlobalObject::navigator()->aircraft().verticalDistanceToString(vDist(), true);
-        auto climbRateMPS = m_positionInfo.attribute(QGeoPositionInfo::VerticalSpeed);
-        if ( qIsFinite(climbRateMPS) ) {
-            if (climbRateMPS < -1.0) {
-                result += QStringLiteral(" ↘");
-            }
-            if ((climbRateMPS >= -1.0) && (climbRateMPS <= +1.0)) {
-                result += QStringLiteral(" →");
-            }
-            if (climbRateMPS > 1.0) {
-                result += QStringLiteral(" ↗");
-            }
-        }
-        results << result;
-    }
-
-    // Set property value
-    auto newDescription = results.join(u"<br>");
-    if (m_description == newDescription) {
+void Traffic::TrafficFactor_WithPosition::setTurnRate(double newTurnRate)
+{
+    // Compare so that NaN equals NaN
+    if ((m_turnRate == newTurnRate) || (qIsNaN(m_turnRate) && qIsNaN(newTurnRate))) {
         return;
     }
-    m_description = newDescription;
-    emit descriptionChanged();
-
+    m_turnRate = newTurnRate;
+    emit turnRateChanged();
 }
 
 
@@ -54,10 +54,12 @@ public:
 
     /*! \brief Copy data from other object
      *
-     *  This method copies all properties from the other object, with two notable exceptions.
+     *  This method copies all properties from the other object, with three notable exceptions.
      *
      *  - The property "animate" is not copied, the property "animate" of this class is not touched.
      *  - The lifeTime of this object is not changed.
+     *  - The properties "trail" and "turnRate" are not copied. They are owned by the
+     *    TrafficDataProvider, which sets them from its track history.
      *
      *  @param other Instance whose properties are copied
      */
@@ -108,6 +110,53 @@ public:
      */
     void setPositionInfo(const Positioning::PositionInfo& newPositionInfo);
 
+    /*! \brief Recent positions of the traffic
+     *
+     *  This property holds recent positions of the traffic, oldest first, and
+     *  can be used to draw a short trail.  The property is set by the
+     *  TrafficDataProvider; it is empty for traffic factors reported by the
+     *  traffic data sources.
+     */
+    Q_PROPERTY(QList<QGeoCoordinate> trail READ trail WRITE setTrail NOTIFY trailChanged)
+
+    /*! \brief Getter method for property with the same name
+     *
+     *  @returns Property trail
+     */
+    [[nodiscard]] auto trail() const -> QList<QGeoCoordinate>
+    {
+        return m_trail;
+    }
+
+    /*! \brief Setter function for property with the same name
+     *
+     *  @param newTrail Property trail
+     */
+    void setTrail(const QList<QGeoCoordinate>& newTrail);
+
+    /*! \brief Turn rate of the traffic
+     *
+     *  Turn rate in degrees per second, positive values for right turns.  NaN if
+     *  unknown.  Traffic receivers do not report this value; it is estimated by
+     *  the TrafficDataProvider from recent positions of the traffic.
+     */
+    Q_PROPERTY(double turnRate READ turnRate WRITE setTurnRate NOTIFY turnRateChanged)
+
+    /*! \brief Getter method for property with the same name
+     *
+     *  @returns Property turnRate
+     */
+    [[nodiscard]] auto turnRate() const -> double
+    {
+        return m_turnRate;
+    }
+
+    /*! \brief Setter function for property with the same name
+     *
+     *  @param newTurnRate Property turnRate
+     */
+    void setTurnRate(double newTurnRate);
+
 
 signals:
     /*! \brief Notifier signal */
@@ -116,10 +165,16 @@ signals:
     /*! \brief Notifier signal */
     void positionInfoChanged();
 
+    /*! \brief Notifier signal */
+    void trailChanged();
+
+    /*! \brief Notifier signal */
+    void turnRateChanged();
+
 
 protected:
     // See documentation in base class
-    void updateDescription() override;
+    [[nodiscard]] auto descriptionKey() const -> DescriptionKey override;
 
     // Updates property icon
     void updateIcon();
@@ -134,6 +189,8 @@ private:
     //
     QString m_icon;
     QGeoPositionInfo m_positionInfo;
+    QList<QGeoCoordinate> m_trail;
+    double m_turnRate {qQNaN()};
     Units::Distance m_vDist;
     Units::Distance m_hDist;
 
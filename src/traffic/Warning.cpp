@@ -87,6 +87,12 @@ Traffic::Warning::Warning(
 }
 
 
+Traffic::Warning::Warning(int alarmLevel, Units::Angle relativeBearing, Units::Distance hDist, Units::Distance vDist)
+    : m_alarmLevel(alarmLevel), m_alarmType(2), m_hDist(hDist), m_relativeBearing(relativeBearing), m_vDist(vDist)
+{
+}
+
+
 auto Traffic::Warning::description() const -> QString
 {
     QStringList result;
@@ -25,13 +25,15 @@
 
 namespace Traffic {
 
+class ConflictPredictor;
 class TrafficDataSource_Abstract;
 
 /*! \brief Traffic warning
  *
  *  Objects of this class represent traffic warnings, as detected by FLARM and
- *  similar devices.  The data fields correspond to the data fields sent out by
- *  FLARM devices with their PFLAU NMEA-sentences.  Instances of this class will
+ *  similar devices, or predicted by the ConflictPredictor.  The data fields
+ *  correspond to the data fields sent out by FLARM devices with their PFLAU
+ *  NMEA-sentences.  Instances of this class will
  *  be generated by the Navigation::TrafficDataSource_* classes. Consumers of
  *  this class will never have to set or construct instances of the class
  *  themselves
@@ -40,6 +42,7 @@ class TrafficDataSource_Abstract;
 class Warning {
     Q_GADGET
 
+    friend ConflictPredictor;
     friend TrafficDataSource_Abstract;
 
 public:
@@ -142,6 +145,13 @@ private:
                      const QString& RelativeVertical,
                      const QString& RelativeDistance);
 
+    // Private constructor, only to be used by ConflictPredictor. Constructs an
+    // aircraft alarm.
+    explicit Warning(int alarmLevel,
+                     Units::Angle relativeBearing,
+                     Units::Distance hDist,
+                     Units::Distance vDist);
+
     // Property values
     int m_alarmLevel {-1};
     int m_alarmType {-1};
@@ -25,10 +25,11 @@
 
 #pragma once
 
+#include <QCoreApplication>
 #include <QDate>
-#include <QObject>
 
 #include <cstring> // Necessary to work around an issue in metaf
+#include <memory>
 
 #include "../3rdParty/metaf/include/metaf.hpp"
 using namespace metaf;
@@ -40,99 +41,87 @@ namespace Weather {
 /*! \brief METAR/TAF decoder
  *
  * This class takes METAR or TAF messages in raw form and converts them to human-readable, translated text.
- * This class is not meant to be used directly. Instead, use the classes Weather::METAR or Weather::TAF.
+ * This class is not meant to be used directly. Instead, use the classes Weather::METAR or Weather::TAF, which
+ * call the decoder when the decoded text is first accessed and cache the result.
  */
 
-class Decoder : public QObject, private metaf::Visitor<QString> {
-    Q_OBJECT
+class Decoder : private metaf::Visitor<QString> {
+    Q_DECLARE_TR_FUNCTIONS(Weather::Decoder)
 
 public:
-    /*! \brief Description of the current weather
-     *
-     * For METAR messages, this property holds a description of the current weather
-     * in translated, human-readable form, such as "low drifting snow" or "light rain".
-     * The property can contain an empty string if there is nothing to report.
-     */
-    Q_PROPERTY(QString currentWeather READ currentWeather NOTIFY rawTextChanged)
-
-    /*! \brief Getter function for property with the same name
-     *
-     * @returns Property currentWeather
-     */
-    [[nodiscard]] auto currentWeather() const -> QString
+    /*! \brief Result of the decoder */
+    struct Result
     {
-        return _currentWeather;
-    }
+        /*! \brief Decoded text of the message, as a human-readable, rich text string */
+        QString decodedText;
 
-    /*! \brief Decoded text of the METAR/TAF message
-     *
-     * This property holds the decoded text of the message, as a human-readable,
-     * rich text string.  The text might change in responde to changes in
-     * user settings, and might also change by midnight (the text uses words such
-     * as 'tomorrow' whose meaning changes at the end of the day).
-     */
-    Q_PROPERTY(QString decodedText READ decodedText NOTIFY decodedTextChanged)
+        /*! \brief Description of the current weather, such as "light rain". Empty if there is nothing to report */
+        QString currentWeather;
+    };
 
-    /*! \brief Getter function for property with the same name
+    /*! \brief Decode METAR/TAF message
+     *
+     * Since METAR/TAF messages specify points in time only by "day of month" and "time", the decoder needs
+     * to know the month and year.
      *
-     * @returns Property decodedText
+     * @param rawText Raw METAR/TAF message, UTF-8 encoded
+     *
+     * @param referenceDate Any date between in the interval [issue date, issue date + 28 days]
+     *
+     * @returns Decoded text and current weather
      */
-    [[nodiscard]] auto decodedText() const -> QString
-    {
-        return _decodedText;
-    }
+    static auto decode(const QByteArray& rawText, QDate referenceDate) -> Weather::Decoder::Result;
 
-    /*! \brief Message Type
+    /*! \brief Key that describes the settings the decoded text depends on
      *
-     * This is a string of the form "METAR", "TAF" or "METAR/SPECI".
+     * The decoded text depends on the current date (it uses words such as 'tomorrow'), on the preferred
+     * unit system and on the application language.  Decoded texts that were generated under a different
+     * key are outdated.
+     *
+     * @returns Key for the current date and settings
      */
-    Q_PROPERTY(QString messageType READ messageType NOTIFY rawTextChanged)
+    static auto decodingKey() -> qint64;
 
-    /*! \brief Getter function for property with the same name
+    /*! \brief Message type
+     *
+     * @param parseResult Result of parse()
      *
-     * @returns Property currentWeather
+     * @returns String of the form "METAR", "TAF" or "METAR/SPECI"
      */
-    [[nodiscard]] auto messageType() const -> QString;
+    static auto messageType(const metaf::ParseResult& parseResult) -> QString;
 
-    /*! \brief Raw text of the METAR/TAF message */
-    Q_PROPERTY(QString rawText READ rawText NOTIFY rawTextChanged)
-
-    /*! \brief Getter function for property with the same name
+    /*! \brief Check for parser errors
+     *
+     * If an error occurs, the decoded text will still be available, but is probably incomplete.
      *
-     * @returns Property rawText
+     * @param parseResult Result of parse()
+     *
+     * @returns True if the parser was not able to read the text without error
      */
-    [[nodiscard]] auto rawText() const -> QString
-    {
-        return _rawText;
-    }
-
-signals:
-    /*! \brief  Notifier signal */
-    void decodedTextChanged();
-
-    /*! \brief  Notifier signal */
-    void rawTextChanged();
-
-protected:
-    // This constructor creates a Decoder instance.  You need to set the raw text before this class can be useful.
-    explicit Decoder(QObject *parent = nullptr);
-
-    // Sets the raw METAR/TAF message and starts processing. Since METAR/TAF messages specify points in time only by "day of month" and "time",
-    // the decoder needs to know the month and year. Set this reference date to any date between in the interval [issue date, issue date + 28 days]
-    void setRawText(const QString& rawText, QDate referenceDate);
-
-    // Indicates if the parser was able to read the text without error. If an error occurs, the decoded will
-    // still be available, but is probably incomplete
-    [[nodiscard]] auto hasParseError() const -> bool
+    static auto hasParseError(const metaf::ParseResult& parseResult) -> bool
     {
         return (parseResult.reportMetadata.error != metaf::ReportError::NONE);
     }
 
-private slots:
-    // This slot does the actual parsing
-    void parse();
+    /*! \brief Run the metaf parser
+     *
+     * The raw bytes are handed to the parser without conversion.  Results are
+     * cached, keyed by the raw bytes, so that reports that are seen repeatedly
+     * (which is the rule, since weather data is refreshed regularly) are parsed
+     * only once.  This method is thread-safe and can be used from worker
+     * threads.
+     *
+     * @param rawText Raw METAR/TAF message, UTF-8 encoded
+     *
+     * @returns Result of the parser. The result is shared and must not be
+     * modified.
+     */
+    static auto parse(const QByteArray& rawText) -> std::shared_ptr<const metaf::ParseResult>;
 
 private:
+    // Instances are used internally by decode() only
+    explicit Decoder(QDate referenceDate);
+
     // Explanation functions
     static auto explainCloudType(const metaf::CloudType &ct) -> QString;
     static auto explainDirection(metaf::Direction direction, bool trueCardinalDirections=true) -> QString;
@@ -198,22 +187,11 @@ private:
     auto visitWindGroup(const WindGroup & group, ReportPart reportPart, const std::string & rawString) -> QString override;
 
 
-    // Cached data
-
-    // Decoded text generated by last run of parser
-    QString _decodedText;
-
-    // Raw text, as set with setRawText(…)
-    QString _rawText;
-
-    // Current weather, as read from METAR
+    // Current weather, as read from METAR by the visitor methods
     QString _currentWeather;
 
-    // Reference date, as set with setRawText(…)
+    // Reference date, as passed to decode(…)
     QDate _referenceDate;
-
-    // Result of the parser
-    ParseResult parseResult;
 };
 
 } // namespace Weather
@@ -24,156 +24,193 @@
 #include "navigation/Navigator.h"
 #include "weather/METAR.h"
 
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <utility>
 
-Weather::METAR::METAR(QObject *parent)
-    : Weather::Decoder(parent)
-{
-
-}
 
+// Static Helper functions
 
-Weather::METAR::METAR(QXmlStreamReader &xml, QObject *parent)
-    : Weather::Decoder(parent)
+// Elements of a METAR in the XML data provided by the Aviation Weather Center
+enum class METARField
 {
+    altim_in_hg,
+    elevation_m,
+    flight_category,
+    latitude,
+    longitude,
+    observation_time,
+    raw_text,
+    station_id,
+    wind_dir_degrees,
+    wind_gust_kt,
+    wind_speed_kt,
+    unknown
+};
+
+// Element names and fields, sorted by name for binary search
+constexpr std::array<std::pair<std::u16string_view, METARField>, 11> metarFields {{
+    {u"altim_in_hg", METARField::altim_in_hg},
+    {u"elevation_m", METARField::elevation_m},
+    {u"flight_category", METARField::flight_category},
+    {u"latitude", METARField::latitude},
+    {u"longitude", METARField::longitude},
+    {u"observation_time", METARField::observation_time},
+    {u"raw_text", METARField::raw_text},
+    {u"station_id", METARField::station_id},
+    {u"wind_dir_degrees", METARField::wind_dir_degrees},
+    {u"wind_gust_kt", METARField::wind_gust_kt},
+    {u"wind_speed_kt", METARField::wind_speed_kt}
+}};
+static_assert(std::is_sorted(metarFields.begin(), metarFields.end()), "metarFields must be sorted by name");
+
+// Field for an element name, found without constructing any QString
+auto metarField(QStringView name) -> METARField
+{
+    std::u16string_view key(name.utf16(), name.size());
+    auto it = std::lower_bound(metarFields.begin(), metarFields.end(), key,
+                               [](const auto& entry, std::u16string_view k) { return entry.first < k; });
+    if ((it == metarFields.end()) || (it->first != key)) {
+        return METARField::unknown;
+    }
+    return it->second;
+}
 
-    while (true) {
-        xml.readNextStartElement();
-        QString name = xml.name().toString();
+// Flight category, as given by the element "flight_category"
+auto flightCategory(QStringView text) -> Weather::METAR::FlightCategory
+{
+    if (text == u"VFR") {
+        return Weather::METAR::VFR;
+    }
+    if (text == u"MVFR") {
+        return Weather::METAR::MVFR;
+    }
+    if (text == u"IFR") {
+        return Weather::METAR::IFR;
+    }
+    if (text == u"LIFR") {
+        return Weather::METAR::LIFR;
+    }
+    return Weather::METAR::unknown;
+}
 
-        // Read Station_ID
-        if (xml.isStartElement() && name == u"station_id"_qs) {
-            m_ICAOCode = xml.readElementText();
-            continue;
-        }
+// Wind direction, as given by the element "wind_dir_degrees". This is NaN for
+// variable wind, which is reported as "VRB".
+auto windDirection(const QString& text) -> Units::Angle
+{
+    bool ok = false;
+    auto directionInDEG = text.toDouble(&ok);
+    if (!ok) {
+        return {};
+    }
+    return Units::Angle::fromDEG(directionInDEG);
+}
 
-        // Read location
-        if (xml.isStartElement() && name == u"latitude"_qs) {
-            _location.setLatitude(xml.readElementText().toDouble());
-            continue;
-        }
-        if (xml.isStartElement() && name == u"longitude"_qs) {
-            _location.setLongitude(xml.readElementText().toDouble());
-            continue;
-        }
-        if (xml.isStartElement() && name == u"elevation_m"_qs) {
-            _location.setAltitude(xml.readElementText().toDouble());
-            continue;
-        }
 
-        // Read raw text
-        if (xml.isStartElement() && name == u"raw_text"_qs) {
-            _raw_text = xml.readElementText();
-            continue;
-        }
+// Member functions
 
-        // QNH
-        if (xml.isStartElement() && name == u"altim_in_hg"_qs) {
-            auto content = xml.readElementText();
-            _qnh = qRound(content.toDouble() * 33.86);
-            if ((_qnh < 800) || (_qnh > 1200)) {
-                _qnh = 0;
-            }
-            continue;
-        }
+Weather::METAR::METAR()
+    : d(new Data)
+{
+}
 
-        // Wind
-        if (xml.isStartElement() && name == u"wind_speed_kt"_qs) {
-            auto content = xml.readElementText();
-            _wind = Units::Speed::fromKN(content.toDouble());
-            continue;
-        }
 
-        // Gust
-        if (xml.isStartElement() && name == u"wind_gust_kt"_qs) {
-            auto content = xml.readElementText();
-            _gust = Units::Speed::fromKN(content.toDouble());
-            continue;
+Weather::METAR::METAR(QXmlStreamReader &xml)
+    : d(new Data)
+{
+    while (true) {
+        xml.readNextStartElement();
+        if (xml.hasError()) {
+            break;
         }
+        auto name = xml.name();
 
-        // QNH
-        if (xml.isStartElement() && name == u"altim_in_hg"_qs) {
-            auto content = xml.readElementText();
-            _qnh = qRound(content.toDouble() * 33.86);
-            if ((_qnh < 800) || (_qnh > 1200)) {
-                _qnh = 0;
-            }
-            continue;
+        if (xml.isEndElement() && (name == u"METAR")) {
+            break;
         }
-
-        // Observation Time
-        if (xml.isStartElement() && name == u"observation_time"_qs) {
-            auto content = xml.readElementText();
-            _observationTime = QDateTime::fromString(content, Qt::ISODate);
+        if (!xml.isStartElement()) {
+            xml.skipCurrentElement();
             continue;
         }
 
-        // Flight category
-        if (xml.isStartElement() && name == u"flight_category"_qs) {
-            auto content = xml.readElementText();
-            if (content == u"VFR"_qs) {
-                _flightCategory = VFR;
-            }
-            if (content == u"MVFR"_qs) {
-                _flightCategory = MVFR;
-            }
-            if (content == u"IFR"_qs) {
-                _flightCategory = IFR;
+        switch(metarField(name)) {
+        case METARField::altim_in_hg:
+            d->QNH = qRound(xml.readElementText().toDouble() * 33.86);
+            if ((d->QNH < 800) || (d->QNH > 1200)) {
+                d->QNH = 0;
             }
-            if (content == u"LIFR"_qs) {
-                _flightCategory = LIFR;
-            }
-            continue;
-        }
-
-        if (xml.isEndElement() && name == u"METAR"_qs) {
+            break;
+        case METARField::elevation_m:
+            d->location.setAltitude(xml.readElementText().toDouble());
+            break;
+        case METARField::flight_category:
+            d->flightCategory = flightCategory(xml.readElementText());
+            break;
+        case METARField::latitude:
+            d->location.setLatitude(xml.readElementText().toDouble());
+            break;
+        case METARField::longitude:
+            d->location.setLongitude(xml.readElementText().toDouble());
+            break;
+        case METARField::observation_time:
+            d->observationTime = QDateTime::fromString(xml.readElementText(), Qt::ISODate);
+            break;
+        case METARField::raw_text:
+            d->rawText = xml.readElementText().toUtf8();
+            break;
+        case METARField::station_id:
+            d->ICAOCode = xml.readElementText();
+            break;
+        case METARField::wind_dir_degrees:
+            d->windDirection = windDirection(xml.readElementText());
+            break;
+        case METARField::wind_gust_kt:
+            d->gust = Units::Speed::fromKN(xml.readElementText().toDouble());
+            break;
+        case METARField::wind_speed_kt:
+            d->wind = Units::Speed::fromKN(xml.readElementText().toDouble());
+            break;
+        case METARField::unknown:
+            xml.skipCurrentElement();
             break;
         }
-
-        xml.skipCurrentElement();
     }
 
     // Interpret the METAR message
-    setRawText(_raw_text, _observationTime.date());
-    setupSignals();
+    parseRawText();
 }
 
 
-Weather::METAR::METAR(QDataStream &inputStream, QObject *parent)
-    : Weather::Decoder(parent)
+void Weather::METAR::ensureDecoded() const
 {
-    inputStream >> _flightCategory;
-    inputStream >> m_ICAOCode;
-    inputStream >> _location;
-    inputStream >> _observationTime;
-    inputStream >> _qnh;
-    inputStream >> _raw_text;
-    inputStream >> _wind;
-    inputStream >> _gust;
-
-    // Interpret the METAR message
-    setRawText(_raw_text, _observationTime.date());
-    setupSignals();
+    auto key = Weather::Decoder::decodingKey();
+    if (d->decodedKey == key) {
+        return;
+    }
+    d->decoded = Weather::Decoder::decode(d->rawText, d->observationTime.date());
+    d->decodedKey = key;
 }
 
 
 auto Weather::METAR::expiration() const -> QDateTime
 {
-    if (_raw_text.contains(u"NOSIG"_qs)) {
-        return _observationTime.addSecs(3LL*60LL*60LL);
+    if (d->rawText.contains("NOSIG")) {
+        return d->observationTime.addSecs(3LL*60LL*60LL);
     }
-    return _observationTime.addSecs(1.5*60*60);
+    return d->observationTime.addSecs(1.5*60*60);
 }
 
 
 auto Weather::METAR::flightCategoryColor() const -> QString
 {
-    if (_flightCategory == VFR) {
+    if (d->flightCategory == VFR) {
         return QStringLiteral("green");
     }
-    if (_flightCategory == MVFR) {
+    if (d->flightCategory == MVFR) {
         return QStringLiteral("yellow");
     }
-    if ((_flightCategory == IFR) || (_flightCategory == LIFR)) {
+    if ((d->flightCategory == IFR) || (d->flightCategory == LIFR)) {
         return QStringLiteral("red");
     }
     return QStringLiteral("transparent");
@@ -192,16 +229,16 @@ auto Weather::METAR::isExpired() const -> bool
 
 auto Weather::METAR::isValid() const -> bool
 {
-    if (!_location.isValid()) {
+    if (!d->location.isValid()) {
         return false;
     }
-    if (!_observationTime.isValid()) {
+    if (!d->observationTime.isValid()) {
         return false;
     }
-    if (m_ICAOCode.isEmpty()) {
+    if (d->ICAOCode.isEmpty()) {
         return false;
     }
-    if (hasParseError()) {
+    if (d->parseError) {
         return false;
     }
 
@@ -209,23 +246,32 @@ auto Weather::METAR::isValid() const -> bool
 }
 
 
-auto Weather::METAR::relativeObservationTime() const -> QString
+auto Weather::METAR::operator==(const Weather::METAR& other) const -> bool
 {
-    if (!_observationTime.isValid()) {
-        return {};
+    if (d == other.d) {
+        return true;
     }
+    return (d->ICAOCode == other.d->ICAOCode)
+            && (d->observationTime == other.d->observationTime)
+            && (d->rawText == other.d->rawText);
+}
+
 
-    return Navigation::Clock::describeTimeDifference(_observationTime);
+void Weather::METAR::parseRawText()
+{
+    auto parseResult = Weather::Decoder::parse(d->rawText);
+    d->messageType = Weather::Decoder::messageType(*parseResult);
+    d->parseError = Weather::Decoder::hasParseError(*parseResult);
 }
 
 
-void Weather::METAR::setupSignals() const
+auto Weather::METAR::relativeObservationTime() const -> QString
 {
-    // Emit notifier signals whenever the time changes
-    connect(GlobalObject::navigator()->clock(), &Navigation::Clock::timeChanged, this, &Weather::METAR::summaryChanged);
-    connect(GlobalObject::navigator()->clock(), &Navigation::Clock::timeChanged, this, &Weather::METAR::relativeObservationTimeChanged);
+    if (!d->observationTime.isValid()) {
+        return {};
+    }
 
-    connect(GlobalObject::navigator(), &Navigation::Navigator::aircraftChanged, this, &Weather::METAR::summaryChanged);
+    return Navigation::Clock::describeTimeDifference(d->observationTime);
 }
 
 
@@ -233,9 +279,9 @@ auto Weather::METAR::summary() const -> QString {
 
     QStringList resultList;
 
-    switch (_flightCategory) {
+    switch (d->flightCategory) {
     case VFR:
-        if (_raw_text.contains(u"CAVOK"_qs)) {
+        if (d->rawText.contains("CAVOK")) {
             resultList << tr("CAVOK");
         } else {
             resultList << tr("VMC");
@@ -255,28 +301,28 @@ auto Weather::METAR::summary() const -> QString {
     }
 
     // Wind and Gusts
-    if (_gust.toKN() > 15) {
+    if (d->gust.toKN() > 15) {
         switch (GlobalObject::navigator()->aircraft().horizontalDistanceUnit()) {
         case Navigation::Aircraft::Kilometer:
-            resultList << tr("gusts of %1 km/h").arg( qRound(_gust.toKMH()) );
+            resultList << tr("gusts of %1 km/h").arg( qRound(d->gust.toKMH()) );
             break;
         case Navigation::Aircraft::StatuteMile:
-            resultList << tr("gusts of %1 mph").arg( qRound(_gust.toMPH()) );
+            resultList << tr("gusts of %1 mph").arg( qRound(d->gust.toMPH()) );
             break;
         case Navigation::Aircraft::NauticalMile:
-            resultList << tr("gusts of %1 kn").arg( qRound(_gust.toKN()) );
+            resultList << tr("gusts of %1 kn").arg( qRound(d->gust.toKN()) );
             break;
         }
-    } else if (_wind.toKN() > 10) {
+    } else if (d->wind.toKN() > 10) {
         switch (GlobalObject::navigator()->aircraft().horizontalDistanceUnit()) {
         case Navigation::Aircraft::Kilometer:
-            resultList << tr("wind at %1 km/h").arg( qRound(_wind.toKMH()) );
+            resultList << tr("wind at %1 km/h").arg( qRound(d->wind.toKMH()) );
             break;
         case Navigation::Aircraft::StatuteMile:
-            resultList << tr("wind at %1 mph").arg( qRound(_wind.toMPH()) );
+            resultList << tr("wind at %1 mph").arg( qRound(d->wind.toMPH()) );
             break;
         case Navigation::Aircraft::NauticalMile:
-            resultList << tr("wind at %1 kn").arg( qRound(_wind.toKN()) );
+            resultList << tr("wind at %1 kn").arg( qRound(d->wind.toKN()) );
             break;
         }
     }
@@ -291,18 +337,14 @@ auto Weather::METAR::summary() const -> QString {
         return {};
     }
 
-    return tr("%1 %2: %3").arg(messageType(), Navigation::Clock::describeTimeDifference(_observationTime), resultList.join(QStringLiteral(" • ")));
+    return tr("%1 %2: %3").arg(messageType(), Navigation::Clock::describeTimeDifference(d->observationTime), resultList.join(QStringLiteral(" • ")));
 }
 
 
-void Weather::METAR::write(QDataStream &out)
+auto Weather::METAR::wind() const -> Weather::Wind
 {
-    out << _flightCategory;
-    out << m_ICAOCode;
-    out << _location;
-    out << _observationTime;
-    out << _qnh;
-    out << _raw_text;
-    out << _wind;
-    out << _gust;
+    Weather::Wind result;
+    result.setSpeed(d->wind);
+    result.setDirectionFrom(d->windDirection);
+    return result;
 }
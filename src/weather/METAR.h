@@ -20,16 +20,21 @@
 
 #pragma once
 
-#include <QDataStream>
+#include <QCoreApplication>
 #include <QGeoCoordinate>
+#include <QQmlEngine>
+#include <QSharedData>
 #include <QXmlStreamReader>
 
+#include "units/Angle.h"
 #include "units/Speed.h"
 #include "weather/Decoder.h"
+#include "weather/Wind.h"
 
 
 namespace Weather {
 
+class WeatherCache;
 class WeatherDataProvider;
 
 /*! \brief METAR report
@@ -37,24 +42,26 @@ class WeatherDataProvider;
  * This class contains the data of a METAR or SPECI report and provided a few
  * methods to access the data. Instances of this class are provided by the
  * WeatherDataProvider class; there is no way to construct valid instances yourself.
+ *
+ * This is an implicitly shared value type. Copies are cheap and share the
+ * data. The decoded text is generated on first access and cached in the
+ * shared data, so all copies profit from it.
  */
 
-class METAR : public Decoder {
-    Q_OBJECT
+class METAR {
+    Q_GADGET
+    QML_VALUE_TYPE(metar)
+    Q_DECLARE_TR_FUNCTIONS(Weather::METAR)
 
+    friend WeatherCache;
     friend WeatherDataProvider;
 
 public:
     /*! \brief Default constructor
      *
      * This constructor creates an invalid METAR instance.
-     *
-     * @param parent The standard QObject parent pointer
      */
-    explicit METAR(QObject *parent = nullptr);
-
-    // Standard destructor
-    ~METAR() override = default;
+    METAR();
 
     /*! \brief Flight category
      *
@@ -84,7 +91,44 @@ public:
      */
     [[nodiscard]] auto coordinate() const -> QGeoCoordinate
     {
-        return _location;
+        return d->location;
+    }
+
+    /*! \brief Description of the current weather
+     *
+     * This property holds a description of the current weather in translated,
+     * human-readable form, such as "low drifting snow" or "light rain".  The
+     * property can contain an empty string if there is nothing to report.
+     */
+    Q_PROPERTY(QString currentWeather READ currentWeather CONSTANT)
+
+    /*! \brief Getter function for property with the same name
+     *
+     * @returns Property currentWeather
+     */
+    [[nodiscard]] auto currentWeather() const -> QString
+    {
+        ensureDecoded();
+        return d->decoded.currentWeather;
+    }
+
+    /*! \brief Decoded text of the METAR message
+     *
+     * This property holds the decoded text of the message, as a human-readable,
+     * rich text string.  The text depends on user settings and on the current
+     * date.  It is generated on first access and cached until date or settings
+     * change.
+     */
+    Q_PROPERTY(QString decodedText READ decodedText CONSTANT)
+
+    /*! \brief Getter function for property with the same name
+     *
+     * @returns Property decodedText
+     */
+    [[nodiscard]] auto decodedText() const -> QString
+    {
+        ensureDecoded();
+        return d->decoded.decodedText;
     }
 
     /*! \brief Expiration time and date
@@ -129,7 +173,7 @@ public:
      */
     [[nodiscard]] auto flightCategory() const -> FlightCategory
     {
-        return _flightCategory;
+        return d->flightCategory;
     }
 
     /*! \brief ICAO code of the station reporting this METAR
@@ -145,7 +189,7 @@ public:
      */
     [[nodiscard]] auto ICAOCode() const -> QString
     {
-        return m_ICAOCode;
+        return d->ICAOCode;
     }
 
     /*! \brief Convenience method to check if this METAR is already expired
@@ -164,6 +208,21 @@ public:
      */
     [[nodiscard]] auto isValid() const -> bool;
 
+    /*! \brief Message Type
+     *
+     * This is a string of the form "METAR" or "METAR/SPECI".
+     */
+    Q_PROPERTY(QString messageType READ messageType CONSTANT)
+
+    /*! \brief Getter function for property with the same name
+     *
+     * @returns Property messageType
+     */
+    [[nodiscard]] auto messageType() const -> QString
+    {
+        return d->messageType;
+    }
+
     /*! \brief Observation time of this METAR */
     Q_PROPERTY(QDateTime observationTime READ observationTime CONSTANT)
 
@@ -173,7 +232,7 @@ public:
      */
     [[nodiscard]] auto observationTime() const -> QDateTime
     {
-        return _observationTime;
+        return d->observationTime;
     }
 
     /*! \brief QNH value in this METAR, in hPa
@@ -189,7 +248,7 @@ public:
      */
     [[nodiscard]] auto QNH() const -> quint16
     {
-        return _qnh;
+        return d->QNH;
     }
 
     /*! \brief Raw METAR text
@@ -205,15 +264,16 @@ public:
      */
     [[nodiscard]] auto rawText() const -> QString
     {
-        return _raw_text;
+        return QString::fromUtf8(d->rawText);
     }
 
     /*! \brief Observation time, relative to now
      *
      * This is a translated, human-readable string such as "1h and 43min ago"
-     * that describes the observation time.
+     * that describes the observation time.  The Station that holds this METAR
+     * emits its notifier signal when the value changes.
      */
-    Q_PROPERTY(QString relativeObservationTime READ relativeObservationTime NOTIFY relativeObservationTimeChanged)
+    Q_PROPERTY(QString relativeObservationTime READ relativeObservationTime CONSTANT)
 
     /*! \brief Getter function for property with the same name
      *
@@ -224,9 +284,10 @@ public:
     /*! \brief One-line summary of the METAR
      *
      * This is a translated, human-readable string of the form "METAR 14min ago:
-     * marginal VMC • wind at 15kt • rain"
+     * marginal VMC • wind at 15kt • rain".  The Station that holds this METAR
+     * emits its notifier signal when the value changes.
      */
-    Q_PROPERTY(QString summary READ summary NOTIFY summaryChanged)
+    Q_PROPERTY(QString summary READ summary CONSTANT)
 
     /*! \brief Getter function for property with the same name
      *
@@ -234,56 +295,86 @@ public:
      */
     [[nodiscard]] auto summary() const -> QString;
 
+    /*! \brief Wind reported in this METAR
+     *
+     * The wind direction is NaN if the wind is variable or if no direction
+     * was reported.
+     */
+    Q_PROPERTY(Weather::Wind wind READ wind CONSTANT)
 
-signals:
-    /*! \brief Notifier signal */
-    void summaryChanged();
+    /*! \brief Getter function for property with the same name
+     *
+     * @returns Property wind
+     */
+    [[nodiscard]] auto wind() const -> Weather::Wind;
 
-    /*! \brief Notifier signal */
-    void relativeObservationTimeChanged();
+    /*! \brief Comparison
+     *
+     * @param other METAR to compare with
+     *
+     * @returns True if both METARs report the same station, observation time
+     * and raw text
+     */
+    [[nodiscard]] auto operator==(const Weather::METAR& other) const -> bool;
 
 protected:
     // This constructor reads a XML stream, as provided by the Aviation Weather
-    // Center's Text Data Server, https://www.aviationweather.gov/dataserver
-    explicit METAR(QXmlStreamReader &xml, QObject *parent = nullptr);
-
-    // This constructor reads a serialized METAR from a QDataStream
-    explicit METAR(QDataStream &inputStream, QObject *parent = nullptr);
+    // Center's Text Data Server, https://www.aviationweather.gov/dataserver.
+    // The raw text is parsed, to check for errors.  The constructor does not
+    // use any QObject and can be used in worker threads.
+    explicit METAR(QXmlStreamReader &xml);
 
 private:
-    // Connects signals; this method is used internally from the constructor(s)
-    void setupSignals() const;
+    // Runs the parser on the raw text and sets messageType and parseError
+    void parseRawText();
+
+    // Generates decoded text and current weather, unless the cache is up to date
+    void ensureDecoded() const;
 
-    // Writes the METAR report to a data stream
-    void write(QDataStream &out);
+    // Data, shared between copies
+    struct Data : public QSharedData
+    {
+        // Flight category, as returned by the Aviation Weather Center
+        FlightCategory flightCategory {unknown};
 
-    Q_DISABLE_COPY_MOVE(METAR)
+        // Gust speed, as returned by the Aviation Weather Center
+        Units::Speed gust;
 
-    // Decoded METAR text
-    QString _decoded;
+        // Station ID, as returned by the Aviation Weather Center
+        QString ICAOCode;
 
-    // Flight category, as returned by the Aviation Weather Center
-    FlightCategory _flightCategory {unknown};
+        // Station coordinate, as returned by the Aviation Weather Center
+        QGeoCoordinate location;
 
-    // Gust speed, as returned by the Aviation Weather Center
-    Units::Speed _gust;
+        // Observation time, as returned by the Aviation Weather Center
+        QDateTime observationTime;
 
-    // Station ID, as returned by the Aviation Weather Center
-    QString m_ICAOCode;
+        // QNH in hPa, as returned by the Aviation Weather Center
+        quint16 QNH {0};
 
-    // Station coordinate, as returned by the Aviation Weather Center
-    QGeoCoordinate _location;
+        // Raw METAR text, as returned by the Aviation Weather Center. The text
+        // is kept UTF-8 encoded, so that it can be handed to the parser
+        // without conversion.
+        QByteArray rawText;
 
-    // Observation time, as returned by the Aviation Weather Center
-    QDateTime _observationTime;
+        // Wind speed, as returned by the Aviation Weather Center
+        Units::Speed wind;
 
-    // QNH in hPa, as returned by the Aviation Weather Center
-    quint16 _qnh {0};
+        // Wind direction, as returned by the Aviation Weather Center. NaN if
+        // the wind is variable or if no direction was reported
+        Units::Angle windDirection;
 
-    // Raw METAR text, as returned by the Aviation Weather Center
-    QString _raw_text;
+        // Results of the parser
+        QString messageType;
+        bool parseError {true};
 
-    // Wind speed, as returned by the Aviation Weather Center
-    Units::Speed _wind;
+        // Decoded text, generated on first access. The key describes the
+        // settings under which the text was generated, see
+        // Decoder::decodingKey()
+        mutable Weather::Decoder::Result decoded;
+        mutable qint64 decodedKey {-1};
+    };
+    QSharedDataPointer<Data> d;
 };
+
 } // namespace Weather
@@ -18,7 +18,10 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include "GlobalObject.h"
 #include "geomaps/GeoMapProvider.h"
+#include "navigation/Clock.h"
+#include "navigation/Navigator.h"
 #include "weather/Station.h"
 
 #include <utility>
@@ -41,6 +44,21 @@ Weather::Station::Station(QString id, GeoMaps::GeoMapProvider *geoMapProvider, Q
     // Wire up with GeoMapProvider, in order to learn about future changes in waypoints
     connect(_geoMapProvider, &GeoMaps::GeoMapProvider::waypointsChanged, this, &Weather::Station::readDataFromWaypoint);
     readDataFromWaypoint();
+
+    // Texts in METAR and TAF depend on time and unit settings
+    connect(GlobalObject::navigator()->clock(), &Navigation::Clock::timeChanged, this, &Weather::Station::onTextsChanged);
+    connect(GlobalObject::navigator(), &Navigation::Navigator::aircraftChanged, this, &Weather::Station::onTextsChanged);
+}
+
+
+void Weather::Station::onTextsChanged()
+{
+    if (hasMETAR()) {
+        emit metarChanged();
+    }
+    if (hasTAF()) {
+        emit tafChanged();
+    }
 }
 
 
@@ -90,14 +108,33 @@ void Weather::Station::readDataFromWaypoint()
 }
 
 
-void Weather::Station::setMETAR(Weather::METAR *metar)
+void Weather::Station::resetMETAR()
+{
+    if (!hasMETAR()) {
+        return;
+    }
+    _metar = {};
+    emit hasMETARChanged();
+    emit metarChanged();
+}
+
+
+void Weather::Station::resetTAF()
+{
+    if (!hasTAF()) {
+        return;
+    }
+    _taf = {};
+    emit hasTAFChanged();
+    emit tafChanged();
+}
+
+
+void Weather::Station::setMETAR(const Weather::METAR& metar)
 {
     // Ignore invalid and expired METARs. Also ignore METARs whose ICAO code does not match with this weather station
-    if (metar != nullptr) {
-        if (!metar->isValid() || metar->isExpired() || (metar->ICAOCode() != m_ICAOCode)) {
-            metar->deleteLater();
-            return;
-        }
+    if (!metar.isValid() || metar.isExpired() || (metar.ICAOCode() != m_ICAOCode)) {
+        return;
     }
 
     // If METAR did not change, then do nothing
@@ -108,27 +145,12 @@ void Weather::Station::setMETAR(Weather::METAR *metar)
     // Cache values
     auto cacheHasMETAR = hasMETAR();
 
-    // Take ownership. This will guarantee that the METAR gets deleted along with this weather station.
-    if (metar != nullptr) {
-        metar->setParent(this);
-    }
-
-    // Clear and delete old METAR, if one exists.
-    if (!_metar.isNull()) {
-        disconnect(_metar, nullptr, this, nullptr);
-        _metar->deleteLater();
-    }
-
-    // Overwrite metar pointer
+    // Overwrite METAR, update the coordinate if necessary.
     _metar = metar;
-
-    if (_metar != nullptr) {
-        // Connect new METAR, update the coordinate if necessary.
-        connect(_metar, &QObject::destroyed, this, &Weather::Station::metarChanged);
-
-        // Update coordinate
-        if (!_coordinate.isValid()) {
-            _coordinate = _metar->coordinate();
+    if (!_coordinate.isValid()) {
+        _coordinate = _metar.coordinate();
+        if (_coordinate.isValid()) {
+            emit coordinateChanged();
         }
     }
 
@@ -140,14 +162,11 @@ void Weather::Station::setMETAR(Weather::METAR *metar)
 }
 
 
-void Weather::Station::setTAF(Weather::TAF *taf)
+void Weather::Station::setTAF(const Weather::TAF& taf)
 {
     // Ignore invalid and expired TAFs. Also ignore TAFs whose ICAO code does not match with this weather station
-    if (taf != nullptr) {
-        if (!taf->isValid() || taf->isExpired() || (taf->ICAOCode() != m_ICAOCode)) {
-            taf->deleteLater();
-            return;
-        }
+    if (!taf.isValid() || taf.isExpired() || (taf.ICAOCode() != m_ICAOCode)) {
+        return;
     }
 
     // If TAF did not change, then do nothing
@@ -158,27 +177,12 @@ void Weather::Station::setTAF(Weather::TAF *taf)
     // Cache values
     auto cacheHasTAF = hasTAF();
 
-    // Take ownership. This will guarantee that the METAR gets deleted along with this weather station.
-    if (taf != nullptr) {
-        taf->setParent(this);
-    }
-
-    // Clear and delete old TAF, if one exists.
-    if (!_taf.isNull()) {
-        disconnect(_taf, nullptr, this, nullptr);
-        _taf->deleteLater();
-    }
-
-    // Overwrite TAF pointer
+    // Overwrite TAF, update the coordinate if necessary.
     _taf = taf;
-
-    if (_taf != nullptr) {
-        // Connect new TAF, update the coordinate if necessary.
-        connect(_taf, &QObject::destroyed, this, &Weather::Station::tafChanged);
-
-        // Update coordinate
-        if (!_coordinate.isValid()) {
-            _coordinate = _taf->coordinate();
+    if (!_coordinate.isValid()) {
+        _coordinate = _taf.coordinate();
+        if (_coordinate.isValid()) {
+            emit coordinateChanged();
         }
     }
 
@@ -105,7 +105,7 @@ public:
      */
     [[nodiscard]] auto hasMETAR() const -> bool
     {
-        return !_metar.isNull();
+        return _metar.isValid();
     }
 
     /*! \brief Check if a TAF weather forecast is known for this weather station
@@ -122,7 +122,7 @@ public:
      */
     [[nodiscard]] auto hasTAF() const -> bool
     {
-        return !_taf.isNull();
+        return _taf.isValid();
     }
 
     /*! \brief ICAO code of the weather station
@@ -171,18 +171,17 @@ public:
 
     /*! \brief Last METAR provided by this WeatherStation
      * 
-     * This property holds a pointer to the last METAR provided by this
-     * WeatherStation, which can be a nullptr if no data is available.  The
-     * METAR instance is owned by an instance of WeatherDataProvider, and can be
-     * deleted or updated by the WeatherDataProvider anytime.
+     * This property holds the last METAR provided by this WeatherStation,
+     * which is invalid if no data is available.  The notifier signal is also
+     * emitted when time-dependent or unit-dependent texts of the METAR change.
      */
-    Q_PROPERTY(Weather::METAR *metar READ metar NOTIFY metarChanged)
+    Q_PROPERTY(Weather::METAR metar READ metar NOTIFY metarChanged)
 
     /*! \brief Getter method for property of the same name
      *
      * @returns Property metar
      */
-    [[nodiscard]] auto metar() const -> Weather::METAR *
+    [[nodiscard]] auto metar() const -> Weather::METAR
     {
         return _metar;
     }
@@ -209,18 +208,17 @@ public:
 
     /*! \brief Last TAF provided by this WeatherStation
      * 
-     * This property holds a pointer to the last TAF provided by this
-     * WeatherStation, which can be a nullptr if no data is available.  The TAF
-     * instance is owned by an instance of WeatherDataProvider, and can be deleted or
-     * updated by the WeatherDataProvider anytime.
+     * This property holds the last TAF provided by this WeatherStation, which
+     * is invalid if no data is available.  The notifier signal is also emitted
+     * when time-dependent or unit-dependent texts of the TAF change.
      */
-    Q_PROPERTY(Weather::TAF *taf READ taf NOTIFY tafChanged)
+    Q_PROPERTY(Weather::TAF taf READ taf NOTIFY tafChanged)
 
     /*! \brief Getter method for property of the same name
      *
      * @returns Property taf
      */
-    [[nodiscard]] auto taf() const -> Weather::TAF *
+    [[nodiscard]] auto taf() const -> Weather::TAF
     {
         return _taf;
     }
@@ -251,6 +249,12 @@ signals:
     void twoLineTitleChanged();
 
 private slots:
+    // Emits metarChanged() and tafChanged() if a METAR or TAF exists. This
+    // method is called whenever time, unit settings or the application
+    // language change, so that QML re-reads the texts that depend on these.
+    // Language changes are forwarded by the WeatherDataProvider.
+    void onTextsChanged();
+
     // This method attempts to find a waypoint matchting this weather station,
     // in order to learn additional data about the station. This method is
     // called automaticall whenever the GeoMapProvider has new data.
@@ -263,18 +267,23 @@ private:
     // WeatherDataProvider class
     explicit Station(QString id, GeoMaps::GeoMapProvider *geoMapProvider, QObject *parent);
 
-    // If the metar is valid, not expired and newer than the existing metar,
-    // this method sets the METAR message and deletes any existing METAR;
-    // otherwise, the metar is deleted. In any case, this WeatherStation will
-    // take ownership of the METAR. The signal metarChanged() will be emitted if
-    // appropriate.
-    void setMETAR(Weather::METAR *metar);
+    // Removes the METAR, if one exists. The signals hasMETARChanged() and
+    // metarChanged() will be emitted if appropriate.
+    void resetMETAR();
+
+    // Removes the TAF, if one exists. The signals hasTAFChanged() and
+    // tafChanged() will be emitted if appropriate.
+    void resetTAF();
+
+    // If the metar is valid, not expired and differs from the existing metar,
+    // this method sets the METAR message; otherwise, the metar is ignored. The
+    // signal metarChanged() will be emitted if appropriate.
+    void setMETAR(const Weather::METAR& metar);
 
-    // If the taf is valid, not expired and newer than the existing taf, this
-    // method sets the TAF message and deletes any existing TAF; otherwise, the
-    // taf is deleted. In any case, this WeatherStation will take ownership of
-    // the TAF. The signal tafChanged() will be emitted if appropriate.
-    void setTAF(Weather::TAF *taf);
+    // If the taf is valid, not expired and differs from the existing taf, this
+    // method sets the TAF message; otherwise, the taf is ignored. The signal
+    // tafChanged() will be emitted if appropriate.
+    void setTAF(const Weather::TAF& taf);
 
     // Coordinate of this weather station
     QGeoCoordinate _coordinate;
@@ -289,10 +298,10 @@ private:
     QString _icon {QStringLiteral("/icons/waypoints/WP.svg")};
 
     // METAR
-    QPointer<Weather::METAR> _metar;
+    Weather::METAR _metar;
 
     // TAF
-    QPointer<Weather::TAF> _taf;
+    Weather::TAF _taf;
 
     // Two-Line-Title
     QString _twoLineTitle;
@@ -0,0 +1,228 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <QtMath>
+#include <algorithm>
+
+#include "weather/StationIndex.h"
+
+
+void Weather::StationIndex::build(qsizetype begin, qsizetype end, int axis)
+{
+    if (end-begin < 2) {
+        return;
+    }
+    auto middle = (begin+end)/2;
+    std::nth_element(m_points.begin()+begin, m_points.begin()+middle, m_points.begin()+end,
+                     [axis](const Point& a, const Point& b) { return a.xyz[axis] < b.xyz[axis]; });
+    build(begin, middle, (axis+1)%3);
+    build(middle+1, end, (axis+1)%3);
+}
+
+
+auto Weather::StationIndex::distanceSquared(const Point& a, const Point& b) -> double
+{
+    auto dx = a.xyz[0]-b.xyz[0];
+    auto dy = a.xyz[1]-b.xyz[1];
+    auto dz = a.xyz[2]-b.xyz[2];
+    return dx*dx + dy*dy + dz*dz;
+}
+
+
+auto Weather::StationIndex::nearest(const QGeoCoordinate& position, const std::function<bool(const Weather::Station*)>& predicate) const -> Weather::Station*
+{
+    if (!position.isValid()) {
+        return nullptr;
+    }
+
+    qsizetype best = -1;
+    double bestDistanceSquared = qInf();
+    nearest(0, static_cast<qsizetype>(m_points.size()), 0, toPoint(position), predicate, best, bestDistanceSquared);
+    if (best < 0) {
+        return nullptr;
+    }
+    return m_points[best].station;
+}
+
+
+void Weather::StationIndex::nearest(qsizetype begin, qsizetype end, int axis, const Point& query, const std::function<bool(const Weather::Station*)>& predicate, qsizetype& best, double& bestDistanceSquared) const
+{
+    if (begin >= end) {
+        return;
+    }
+    auto middle = (begin+end)/2;
+    const auto& point = m_points[middle];
+
+    auto distance = distanceSquared(point, query);
+    if ((distance < bestDistanceSquared) && !point.station.isNull() && predicate(point.station)) {
+        best = middle;
+        bestDistanceSquared = distance;
+    }
+
+    // Search the half that contains the query first. Search the other half
+    // only if the splitting plane is nearer than the best station found.
+    auto delta = query.xyz[axis]-point.xyz[axis];
+    auto nextAxis = (axis+1)%3;
+    if (delta < 0) {
+        nearest(begin, middle, nextAxis, query, predicate, best, bestDistanceSquared);
+        if (delta*delta < bestDistanceSquared) {
+            nearest(middle+1, end, nextAxis, query, predicate, best, bestDistanceSquared);
+        }
+    } else {
+        nearest(middle+1, end, nextAxis, query, predicate, best, bestDistanceSquared);
+        if (delta*delta < bestDistanceSquared) {
+            nearest(begin, middle, nextAxis, query, predicate, best, bestDistanceSquared);
+        }
+    }
+}
+
+
+auto Weather::StationIndex::nearest(const QGeoCoordinate& position, qsizetype count, const std::function<bool(const Weather::Station*)>& predicate) const -> QList<Weather::Station*>
+{
+    if (!position.isValid() || (count <= 0)) {
+        return {};
+    }
+
+    std::vector<std::pair<double, qsizetype>> best;
+    best.reserve(count+1);
+    nearest(0, static_cast<qsizetype>(m_points.size()), 0, toPoint(position), count, predicate, best);
+
+    QList<Weather::Station*> result;
+    result.reserve(static_cast<qsizetype>(best.size()));
+    for(const auto& entry : best) {
+        result << m_points[entry.second].station;
+    }
+    return result;
+}
+
+
+void Weather::StationIndex::nearest(qsizetype begin, qsizetype end, int axis, const Point& query, qsizetype count, const std::function<bool(const Weather::Station*)>& predicate, std::vector<std::pair<double, qsizetype>>& best) const
+{
+    if (begin >= end) {
+        return;
+    }
+    auto middle = (begin+end)/2;
+    const auto& point = m_points[middle];
+
+    // Squared distance of the farthest station in best, or infinity if best
+    // is not yet full
+    auto bound = [&]() {
+        return (static_cast<qsizetype>(best.size()) < count) ? qInf() : best.back().first;
+    };
+
+    auto distance = distanceSquared(point, query);
+    if ((distance < bound()) && !point.station.isNull() && predicate(point.station)) {
+        auto it = std::upper_bound(best.begin(), best.end(), distance,
+                                   [](double d, const auto& entry) { return d < entry.first; });
+        best.insert(it, {distance, middle});
+        if (static_cast<qsizetype>(best.size()) > count) {
+            best.pop_back();
+        }
+    }
+
+    // Search the half that contains the query first, as in the search for a
+    // single station
+    auto delta = query.xyz[axis]-point.xyz[axis];
+    auto nextAxis = (axis+1)%3;
+    if (delta < 0) {
+        nearest(begin, middle, nextAxis, query, count, predicate, best);
+        if (delta*delta < bound()) {
+            nearest(middle+1, end, nextAxis, query, count, predicate, best);
+        }
+    } else {
+        nearest(middle+1, end, nextAxis, query, count, predicate, best);
+        if (delta*delta < bound()) {
+            nearest(begin, middle, nextAxis, query, count, predicate, best);
+        }
+    }
+}
+
+
+void Weather::StationIndex::rebuild(const QList<Weather::Station*>& stations)
+{
+    m_points.clear();
+    m_points.reserve(stations.size());
+    m_withoutCoordinate.clear();
+    m_stations.clear();
+    m_stations.reserve(stations.size());
+
+    foreach(auto station, stations) {
+        if (station == nullptr) {
+            continue;
+        }
+        m_stations << station;
+        if (!station->coordinate().isValid()) {
+            m_withoutCoordinate << station;
+            continue;
+        }
+        auto point = toPoint(station->coordinate());
+        point.station = station;
+        m_points.push_back(point);
+    }
+    build(0, static_cast<qsizetype>(m_points.size()), 0);
+}
+
+
+auto Weather::StationIndex::sortedByDistance(const QGeoCoordinate& position) const -> QList<Weather::Station*>
+{
+    QList<Weather::Station*> result;
+    result.reserve(m_stations.size());
+
+    if (!position.isValid()) {
+        foreach(auto station, m_stations) {
+            if (!station.isNull()) {
+                result << station;
+            }
+        }
+        return result;
+    }
+
+    // Compute every distance once, then sort
+    auto query = toPoint(position);
+    std::vector<std::pair<double, Weather::Station*>> stationsByDistance;
+    stationsByDistance.reserve(m_points.size());
+    for(const auto& point : m_points) {
+        if (!point.station.isNull()) {
+            stationsByDistance.emplace_back(distanceSquared(point, query), point.station);
+        }
+    }
+    std::sort(stationsByDistance.begin(), stationsByDistance.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    for(const auto& entry : stationsByDistance) {
+        result << entry.second;
+    }
+    foreach(auto station, m_withoutCoordinate) {
+        if (!station.isNull()) {
+            result << station;
+        }
+    }
+    return result;
+}
+
+
+auto Weather::StationIndex::toPoint(const QGeoCoordinate& coordinate) -> Weather::StationIndex::Point
+{
+    auto latRAD = qDegreesToRadians(coordinate.latitude());
+    auto lonRAD = qDegreesToRadians(coordinate.longitude());
+    Point result;
+    result.xyz = {qCos(latRAD)*qCos(lonRAD), qCos(latRAD)*qSin(lonRAD), qSin(latRAD)};
+    return result;
+}
@@ -0,0 +1,135 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QGeoCoordinate>
+#include <QList>
+#include <QPointer>
+#include <array>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "weather/Station.h"
+
+
+namespace Weather {
+
+/*! \brief Spatial index over weather stations
+ *
+ *  This class holds the coordinates of weather stations in a k-d tree, in
+ *  order to answer nearest-station and sorted-by-distance queries quickly.
+ *  Coordinates are stored as points on the unit sphere, in earth-centered
+ *  cartesian coordinates.  The straight-line distance between two such points
+ *  grows monotonically with the great-circle distance, so that comparisons
+ *  need no trigonometry and work across the antimeridian.
+ *
+ *  The index does not watch the stations. Call rebuild() whenever stations
+ *  have been added or removed, or when their coordinates have changed.
+ *  Nearest-station queries take O(log n) time for n stations.
+ */
+class StationIndex {
+
+public:
+    /*! \brief Rebuild index
+     *
+     *  @param stations Weather stations. Stations without valid coordinate are
+     *  kept, but never considered in nearest().
+     */
+    void rebuild(const QList<Weather::Station*>& stations);
+
+    /*! \brief Nearest station that satisfies a condition
+     *
+     *  @param position Position
+     *
+     *  @param predicate Condition. Stations for which the predicate returns
+     *  false are ignored.
+     *
+     *  @returns Nearest station that satisfies the condition, or nullptr if
+     *  there is no such station or if the position is invalid
+     */
+    [[nodiscard]] auto nearest(const QGeoCoordinate& position, const std::function<bool(const Weather::Station*)>& predicate) const -> Weather::Station*;
+
+    /*! \brief Nearest stations that satisfy a condition
+     *
+     *  @param position Position
+     *
+     *  @param count Maximal number of stations
+     *
+     *  @param predicate Condition. Stations for which the predicate returns
+     *  false are ignored.
+     *
+     *  @returns Up to count stations that satisfy the condition, nearest
+     *  first. The list is empty if the position is invalid.
+     */
+    [[nodiscard]] auto nearest(const QGeoCoordinate& position, qsizetype count, const std::function<bool(const Weather::Station*)>& predicate) const -> QList<Weather::Station*>;
+
+    /*! \brief All stations, sorted by distance
+     *
+     *  The distance of every station is computed once.
+     *
+     *  @param position Position
+     *
+     *  @returns All stations, nearest first. Stations without valid
+     *  coordinate are found at the end of the list. If the position is
+     *  invalid, stations are returned in the order given to rebuild().
+     */
+    [[nodiscard]] auto sortedByDistance(const QGeoCoordinate& position) const -> QList<Weather::Station*>;
+
+private:
+    // Point on the unit sphere
+    struct Point
+    {
+        std::array<double, 3> xyz {};
+        QPointer<Weather::Station> station;
+    };
+
+    // Converts a coordinate into a point on the unit sphere
+    static auto toPoint(const QGeoCoordinate& coordinate) -> Weather::StationIndex::Point;
+
+    // Squared distance between two points
+    static auto distanceSquared(const Point& a, const Point& b) -> double;
+
+    // Arrange m_points[begin, end) as a balanced k-d tree, splitting on the
+    // given axis. The root of the subtree is found at (begin+end)/2.
+    void build(qsizetype begin, qsizetype end, int axis);
+
+    // Search the subtree m_points[begin, end) for a station that satisfies
+    // the predicate and is nearer than best
+    void nearest(qsizetype begin, qsizetype end, int axis, const Point& query, const std::function<bool(const Weather::Station*)>& predicate, qsizetype& best, double& bestDistanceSquared) const;
+
+    // Search the subtree m_points[begin, end) for stations that satisfy the
+    // predicate and are nearer than the stations in best. The list best holds
+    // pairs of squared distance and index, nearest first, and never grows
+    // beyond count.
+    void nearest(qsizetype begin, qsizetype end, int axis, const Point& query, qsizetype count, const std::function<bool(const Weather::Station*)>& predicate, std::vector<std::pair<double, qsizetype>>& best) const;
+
+    // Stations with valid coordinate, as k-d tree
+    std::vector<Point> m_points;
+
+    // Stations without valid coordinate
+    QList<QPointer<Weather::Station>> m_withoutCoordinate;
+
+    // All stations, in the order given to rebuild()
+    QList<QPointer<Weather::Station>> m_stations;
+};
+
+} // namespace Weather
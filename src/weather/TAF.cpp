@@ -18,118 +18,151 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
-#include <QDataStream>
 #include <QXmlStreamAttribute>
 
-#include "GlobalObject.h"
 #include "navigation/Clock.h"
-#include "navigation/Navigator.h"
 #include "weather/TAF.h"
 
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <utility>
 
-Weather::TAF::TAF(QObject *parent)
-    : Weather::Decoder(parent)
-{
 
+// Static Helper functions
+
+// Elements of a TAF in the XML data provided by the Aviation Weather Center
+enum class TAFField
+{
+    elevation_m,
+    issue_time,
+    latitude,
+    longitude,
+    raw_text,
+    station_id,
+    valid_time_to,
+    unknown
+};
+
+// Element names and fields, sorted by name for binary search
+constexpr std::array<std::pair<std::u16string_view, TAFField>, 7> tafFields {{
+    {u"elevation_m", TAFField::elevation_m},
+    {u"issue_time", TAFField::issue_time},
+    {u"latitude", TAFField::latitude},
+    {u"longitude", TAFField::longitude},
+    {u"raw_text", TAFField::raw_text},
+    {u"station_id", TAFField::station_id},
+    {u"valid_time_to", TAFField::valid_time_to}
+}};
+static_assert(std::is_sorted(tafFields.begin(), tafFields.end()), "tafFields must be sorted by name");
+
+// Field for an element name, found without constructing any QString
+auto tafField(QStringView name) -> TAFField
+{
+    std::u16string_view key(name.utf16(), name.size());
+    auto it = std::lower_bound(tafFields.begin(), tafFields.end(), key,
+                               [](const auto& entry, std::u16string_view k) { return entry.first < k; });
+    if ((it == tafFields.end()) || (it->first != key)) {
+        return TAFField::unknown;
+    }
+    return it->second;
 }
 
 
-Weather::TAF::TAF(QXmlStreamReader &xml, QObject *parent)
-    : Weather::Decoder(parent)
+// Member functions
+
+Weather::TAF::TAF()
+    : d(new Data)
 {
+}
+
 
+Weather::TAF::TAF(QXmlStreamReader &xml)
+    : d(new Data)
+{
     while (true) {
         xml.readNextStartElement();
-        QString name = xml.name().toString();
-
-        // Read Station_ID
-        if (xml.isStartElement() && name == u"station_id"_qs) {
-            m_ICAOCode = xml.readElementText();
-            continue;
-        }
-
-        // Read location
-        if (xml.isStartElement() && name == u"latitude"_qs) {
-            _location.setLatitude(xml.readElementText().toDouble());
-            continue;
-        }
-        if (xml.isStartElement() && name == u"longitude"_qs) {
-            _location.setLongitude(xml.readElementText().toDouble());
-            continue;
-        }
-        if (xml.isStartElement() && name == u"elevation_m"_qs) {
-            _location.setAltitude(xml.readElementText().toDouble());
-            continue;
-        }
-
-        // Read raw text
-        if (xml.isStartElement() && name == u"raw_text"_qs) {
-            _raw_text = xml.readElementText();
-            continue;
+        if (xml.hasError()) {
+            break;
         }
+        auto name = xml.name();
 
-        // Read issue time
-        if (xml.isStartElement() && name == u"issue_time"_qs) {
-            _issueTime = QDateTime::fromString(xml.readElementText(), Qt::ISODate);
-            continue;
+        if (xml.isEndElement() && (name == u"TAF")) {
+            break;
         }
-
-        // Read expiration date
-        if (xml.isStartElement() && name == u"valid_time_to"_qs) {
-            _expirationTime = QDateTime::fromString(xml.readElementText(), Qt::ISODate);
+        if (!xml.isStartElement()) {
+            xml.skipCurrentElement();
             continue;
         }
 
-        if (xml.isEndElement() && name == u"TAF"_qs) {
+        switch(tafField(name)) {
+        case TAFField::elevation_m:
+            d->location.setAltitude(xml.readElementText().toDouble());
+            break;
+        case TAFField::issue_time:
+            d->issueTime = QDateTime::fromString(xml.readElementText(), Qt::ISODate);
+            break;
+        case TAFField::latitude:
+            d->location.setLatitude(xml.readElementText().toDouble());
+            break;
+        case TAFField::longitude:
+            d->location.setLongitude(xml.readElementText().toDouble());
+            break;
+        case TAFField::raw_text:
+            d->rawText = xml.readElementText().toUtf8();
+            break;
+        case TAFField::station_id:
+            d->ICAOCode = xml.readElementText();
+            break;
+        case TAFField::valid_time_to:
+            d->expirationTime = QDateTime::fromString(xml.readElementText(), Qt::ISODate);
+            break;
+        case TAFField::unknown:
+            xml.skipCurrentElement();
             break;
         }
-
-        xml.skipCurrentElement();
     }
 
-    setRawText(_raw_text, _issueTime.date().addDays(5));
-    setupSignals();
+    // Interpret the TAF message
+    parseRawText();
 }
 
 
-Weather::TAF::TAF(QDataStream &inputStream, QObject *parent)
-    : Weather::Decoder(parent)
+void Weather::TAF::ensureDecoded() const
 {
-    inputStream >> _expirationTime;
-    inputStream >> m_ICAOCode;
-    inputStream >> _issueTime;
-    inputStream >> _location;
-    inputStream >> _raw_text;
-
-    setRawText(_raw_text, _issueTime.date().addDays(5));
-    setupSignals();
+    auto key = Weather::Decoder::decodingKey();
+    if (d->decodedKey == key) {
+        return;
+    }
+    d->decodedText = Weather::Decoder::decode(d->rawText, d->issueTime.date().addDays(5)).decodedText;
+    d->decodedKey = key;
 }
 
 
 auto Weather::TAF::isExpired() const -> bool
 {
-    if (!_expirationTime.isValid()) {
+    if (!d->expirationTime.isValid()) {
         return true;
     }
-    return QDateTime::currentDateTime() > _expirationTime;
+    return QDateTime::currentDateTime() > d->expirationTime;
 }
 
 
 auto Weather::TAF::isValid() const -> bool
 {
-    if (!_location.isValid()) {
+    if (!d->location.isValid()) {
         return false;
     }
-    if (!_expirationTime.isValid()) {
+    if (!d->expirationTime.isValid()) {
         return false;
     }
-    if (!_issueTime.isValid()) {
+    if (!d->issueTime.isValid()) {
         return false;
     }
-    if (m_ICAOCode.isEmpty()) {
+    if (d->ICAOCode.isEmpty()) {
         return false;
     }
-    if (hasParseError()) {
+    if (d->parseError) {
         return false;
     }
 
@@ -137,28 +170,30 @@ auto Weather::TAF::isValid() const -> bool
 }
 
 
-auto Weather::TAF::relativeIssueTime() const -> QString
+auto Weather::TAF::operator==(const Weather::TAF& other) const -> bool
 {
-    if (!_issueTime.isValid()) {
-        return {};
+    if (d == other.d) {
+        return true;
     }
-
-    return Navigation::Clock::describeTimeDifference(_issueTime);
+    return (d->ICAOCode == other.d->ICAOCode)
+            && (d->issueTime == other.d->issueTime)
+            && (d->rawText == other.d->rawText);
 }
 
 
-void Weather::TAF::setupSignals() const
+void Weather::TAF::parseRawText()
 {
-    // Emit notifier signals whenever the time changes
-    connect(GlobalObject::navigator()->clock(), &Navigation::Clock::timeChanged, this, &Weather::TAF::relativeIssueTimeChanged);
+    auto parseResult = Weather::Decoder::parse(d->rawText);
+    d->messageType = Weather::Decoder::messageType(*parseResult);
+    d->parseError = Weather::Decoder::hasParseError(*parseResult);
 }
 
 
-void Weather::TAF::write(QDataStream &out)
+auto Weather::TAF::relativeIssueTime() const -> QString
 {
-    out << _expirationTime;
-    out << m_ICAOCode;
-    out << _issueTime;
-    out << _location;
-    out << _raw_text;
+    if (!d->issueTime.isValid()) {
+        return {};
+    }
+
+    return Navigation::Clock::describeTimeDifference(d->issueTime);
 }
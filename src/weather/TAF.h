@@ -20,8 +20,10 @@
 
 #pragma once
 
-#include <QDataStream>
+#include <QCoreApplication>
 #include <QGeoCoordinate>
+#include <QQmlEngine>
+#include <QSharedData>
 #include <QXmlStreamReader>
 
 #include "weather/Decoder.h"
@@ -29,6 +31,7 @@
 
 namespace Weather {
 
+class WeatherCache;
 class WeatherDataProvider;
 
 
@@ -37,24 +40,25 @@ class WeatherDataProvider;
  * This class contains the data of a TAF report and provided a few
  * methods to access the data. Instances of this class are provided by the
  * WeatherDataProvider class; there is no way to construct valid instances yourself.
+ *
+ * This is an implicitly shared value type. Copies are cheap and share the
+ * data, including the decoded text, which is generated on first access.
  */
 
-class TAF : public Decoder {
-    Q_OBJECT
+class TAF {
+    Q_GADGET
+    QML_VALUE_TYPE(taf)
+    Q_DECLARE_TR_FUNCTIONS(Weather::TAF)
 
+    friend WeatherCache;
     friend WeatherDataProvider;
 
 public:
     /*! \brief Default constructor
      *
      * This constructor creates an invalid TAF instance.
-     *
-     * @param parent The standard QObject parent pointer
      */
-    explicit TAF(QObject *parent = nullptr);
-
-    // Standard destructor
-    ~TAF() override = default;
+    TAF();
 
     /*! \brief Geographical coordinate of the station reporting this TAF
      *
@@ -68,7 +72,26 @@ public:
      */
     [[nodiscard]] auto coordinate() const -> QGeoCoordinate
     {
-        return _location;
+        return d->location;
+    }
+
+    /*! \brief Decoded text of the TAF message
+     *
+     * This property holds the decoded text of the message, as a human-readable,
+     * rich text string.  The text depends on user settings and on the current
+     * date.  It is generated on first access and cached until date or settings
+     * change.
+     */
+    Q_PROPERTY(QString decodedText READ decodedText CONSTANT)
+
+    /*! \brief Getter function for property with the same name
+     *
+     * @returns Property decodedText
+     */
+    [[nodiscard]] auto decodedText() const -> QString
+    {
+        ensureDecoded();
+        return d->decodedText;
     }
 
     /*! \brief Expiration time and date
@@ -83,7 +106,7 @@ public:
      */
     [[nodiscard]] auto expiration() const -> QDateTime
     {
-        return _expirationTime;
+        return d->expirationTime;
     }
 
     /*! \brief ICAO code of the station reporting this TAF
@@ -99,7 +122,7 @@ public:
      */
     [[nodiscard]] auto ICAOCode() const -> QString
     {
-        return m_ICAOCode;
+        return d->ICAOCode;
     }
 
     /*! \brief Convenience method to check if this TAF is already expired
@@ -126,7 +149,22 @@ public:
      */
     [[nodiscard]] auto issueTime() const -> QDateTime
     {
-        return _issueTime;
+        return d->issueTime;
+    }
+
+    /*! \brief Message Type
+     *
+     * This is usually the string "TAF".
+     */
+    Q_PROPERTY(QString messageType READ messageType CONSTANT)
+
+    /*! \brief Getter function for property with the same name
+     *
+     * @returns Property messageType
+     */
+    [[nodiscard]] auto messageType() const -> QString
+    {
+        return d->messageType;
     }
 
     /*! \brief  Raw TAF text
@@ -141,15 +179,16 @@ public:
      */
     [[nodiscard]] auto rawText() const -> QString
     {
-        return _raw_text;
+        return QString::fromUtf8(d->rawText);
     }
 
     /*! \brief Issue time, relative to now
      *
      * This is a translated, human-readable string such as "1h and 43min ago" that describes
-     * the observation time.
+     * the observation time.  The Station that holds this TAF emits its notifier
+     * signal when the value changes.
      */
-    Q_PROPERTY(QString relativeIssueTime READ relativeIssueTime NOTIFY relativeIssueTimeChanged)
+    Q_PROPERTY(QString relativeIssueTime READ relativeIssueTime CONSTANT)
 
     /*! \brief Getter function for property with the same name
      *
@@ -157,40 +196,60 @@ public:
      */
     [[nodiscard]] auto relativeIssueTime() const -> QString;
 
-signals:
-    /*! \brief Notifier signal */
-    void relativeIssueTimeChanged();
-
-private:
-    // This constructor reads a XML stream, as provided by the Aviation Weather Center's Text Data Server,
-    // https://www.aviationweather.gov/dataserver
-    explicit TAF(QXmlStreamReader &xml, QObject *parent = nullptr);
-
-    // This constructor reads a serialized TAF from a QDataStream
-    explicit TAF(QDataStream &inputStream, QObject *parent = nullptr);
-
-    // Connects signals; this method is used internally from the constructor(s)
-    void setupSignals() const;
-
-    // Writes the TAF report to a data stream
-    void write(QDataStream &out);
-
-    Q_DISABLE_COPY_MOVE(TAF)
-
-    // Expiration time
-    QDateTime _expirationTime;
+    /*! \brief Comparison
+     *
+     * @param other TAF to compare with
+     *
+     * @returns True if both TAFs report the same station, issue time and raw
+     * text
+     */
+    [[nodiscard]] auto operator==(const Weather::TAF& other) const -> bool;
 
-    // Station ID, as returned by the Aviation Weather Center
-    QString m_ICAOCode;
+protected:
+    // This constructor reads a XML stream, as provided by the Aviation Weather
+    // Center's Text Data Server, https://www.aviationweather.gov/dataserver.
+    // The raw text is parsed, to check for errors.  The constructor does not
+    // use any QObject and can be used in worker threads.
+    explicit TAF(QXmlStreamReader &xml);
 
-    // Issue time, as returned by the Aviation Weather Center
-    QDateTime _issueTime;
+private:
+    // Runs the parser on the raw text and sets messageType and parseError
+    void parseRawText();
 
-    // Station coordinate, as returned by the Aviation Weather Center
-    QGeoCoordinate _location;
+    // Generates decoded text, unless the cache is up to date
+    void ensureDecoded() const;
 
-    // Raw TAF text, as returned by the Aviation Weather Center
-    QString _raw_text;
+    // Data, shared between copies
+    struct Data : public QSharedData
+    {
+        // Expiration time
+        QDateTime expirationTime;
+
+        // Station ID, as returned by the Aviation Weather Center
+        QString ICAOCode;
+
+        // Issue time, as returned by the Aviation Weather Center
+        QDateTime issueTime;
+
+        // Station coordinate, as returned by the Aviation Weather Center
+        QGeoCoordinate location;
+
+        // Raw TAF text, as returned by the Aviation Weather Center. The text
+        // is kept UTF-8 encoded, so that it can be handed to the parser
+        // without conversion.
+        QByteArray rawText;
+
+        // Results of the parser
+        QString messageType;
+        bool parseError {true};
+
+        // Decoded text, generated on first access. The key describes the
+        // settings under which the text was generated, see
+        // Decoder::decodingKey()
+        mutable QString decodedText;
+        mutable qint64 decodedKey {-1};
+    };
+    QSharedDataPointer<Data> d;
 };
 
 } // namespace Weather
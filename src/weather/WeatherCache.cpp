@@ -0,0 +1,460 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <QSaveFile>
+#include <QTimeZone>
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+#include "weather/WeatherCache.h"
+
+#include <utility>
+
+
+// Static Helper functions
+
+// Layout of the file header
+const char cacheMagic[8] = {'E', 'N', 'R', 'T', 'W', 'T', 'H', 'R'};
+const quint32 cacheVersion = 2;
+const qint64 offsetVersion = 8;
+const qint64 offsetRecordSize = 12;
+const qint64 offsetCapacity = 16;
+const qint64 offsetLastUpdate = 24;
+const qint64 offsetStringTableSize = 32;
+const qint64 offsetDeadStringBytes = 40;
+
+// Layout of a station record. Offsets of raw texts are relative to the start
+// of the string table.
+const qint64 offsetICAOCode = 0;
+const qint64 offsetFlags = 8;
+const qint64 offsetMETARQNH = 12;
+const qint64 offsetMETARFlightCategory = 14;
+const qint64 offsetMETARObservationTime = 16;
+const qint64 offsetMETARLocation = 24;
+const qint64 offsetMETARWind = 48;
+const qint64 offsetMETARGust = 56;
+const qint64 offsetMETARText = 64;
+const qint64 offsetTAFIssueTime = 72;
+const qint64 offsetTAFExpirationTime = 80;
+const qint64 offsetTAFLocation = 88;
+const qint64 offsetTAFText = 112;
+const qint64 offsetMETARWindDirection = 120;
+
+// Flags of a station record
+const quint32 flagHasMETAR = 1;
+const quint32 flagHasTAF = 2;
+const quint32 flagIsSPECI = 4;
+
+// Stored in place of invalid QDateTimes
+const qint64 invalidTime = std::numeric_limits<qint64>::min();
+
+// Checks if the header found at data is a valid cache file header, for a file
+// of the given size
+auto isValidCacheHeader(const uchar* data, qint64 fileSize) -> bool
+{
+    if (fileSize < Weather::WeatherCache::headerSize) {
+        return false;
+    }
+    if (memcmp(data, cacheMagic, sizeof(cacheMagic)) != 0) {
+        return false;
+    }
+    if (qFromLittleEndian<quint32>(data+offsetVersion) != cacheVersion) {
+        return false;
+    }
+    if (qFromLittleEndian<quint32>(data+offsetRecordSize) != Weather::WeatherCache::stationRecordSize) {
+        return false;
+    }
+    auto capacity = qFromLittleEndian<qint64>(data+offsetCapacity);
+    auto stringTableSize = qFromLittleEndian<qint64>(data+offsetStringTableSize);
+    return (capacity >= 0) && (stringTableSize >= 0)
+            && (Weather::WeatherCache::headerSize + capacity*Weather::WeatherCache::stationRecordSize + stringTableSize <= fileSize);
+}
+
+auto readTime(const uchar* data) -> QDateTime
+{
+    auto msecs = qFromLittleEndian<qint64>(data);
+    if (msecs == invalidTime) {
+        return {};
+    }
+    return QDateTime::fromMSecsSinceEpoch(msecs, QTimeZone::utc());
+}
+
+void writeTime(const QDateTime& time, uchar* data)
+{
+    qToLittleEndian<qint64>(time.isValid() ? time.toMSecsSinceEpoch() : invalidTime, data);
+}
+
+auto readCoordinate(const uchar* data) -> QGeoCoordinate
+{
+    return {qFromLittleEndian<double>(data), qFromLittleEndian<double>(data+8), qFromLittleEndian<double>(data+16)};
+}
+
+void writeCoordinate(const QGeoCoordinate& coordinate, uchar* data)
+{
+    qToLittleEndian<double>(coordinate.latitude(), data);
+    qToLittleEndian<double>(coordinate.longitude(), data+8);
+    qToLittleEndian<double>((coordinate.type() == QGeoCoordinate::Coordinate3D) ? coordinate.altitude() : qQNaN(), data+16);
+}
+
+
+// Member functions
+
+Weather::WeatherCache::WeatherCache(QString fileName)
+    : m_fileName(std::move(fileName))
+{
+}
+
+
+auto Weather::WeatherCache::compact() -> bool
+{
+    m_capacity = qMax(minCapacity, static_cast<qint64>(2*m_stations.size()));
+    m_freeSlots.clear();
+    m_stringTableSize = 0;
+    m_deadStringBytes = 0;
+
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QByteArray stringTable;
+    qint64 slot = 0;
+    for(auto it = m_stations.begin(); it != m_stations.end(); it++) {
+        auto& station = it.value();
+        station.slot = slot++;
+
+        auto rawText = station.metar.d->rawText;
+        station.metarOffset = stringTable.size();
+        station.metarLength = rawText.size();
+        stringTable += rawText;
+
+        rawText = station.taf.d->rawText;
+        station.tafOffset = stringTable.size();
+        station.tafLength = rawText.size();
+        stringTable += rawText;
+    }
+    for(auto freeSlot = m_capacity-1; freeSlot >= slot; freeSlot--) {
+        m_freeSlots << freeSlot;
+    }
+    m_stringTableSize = stringTable.size();
+
+    // Write all station slots, then the string table, then the header
+    file.write(QByteArray(headerSize + m_capacity*stationRecordSize, 0));
+    file.write(stringTable);
+    for(auto it = m_stations.cbegin(); it != m_stations.cend(); it++) {
+        writeStationRecord(file, it.key(), it.value());
+    }
+    writeHeader(file);
+    return file.commit();
+}
+
+
+auto Weather::WeatherCache::load() -> bool
+{
+    m_stations.clear();
+    m_freeSlots.clear();
+    m_capacity = 0;
+    m_stringTableSize = 0;
+    m_deadStringBytes = 0;
+    m_lastUpdate = {};
+
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    auto fileSize = file.size();
+    if (fileSize < headerSize) {
+        return false;
+    }
+    auto* data = file.map(0, fileSize);
+    if (data == nullptr) {
+        return false;
+    }
+    if (!isValidCacheHeader(data, fileSize)) {
+        file.unmap(data);
+        return false;
+    }
+
+    m_capacity = qFromLittleEndian<qint64>(data+offsetCapacity);
+    m_lastUpdate = readTime(data+offsetLastUpdate);
+    m_stringTableSize = qFromLittleEndian<qint64>(data+offsetStringTableSize);
+    m_deadStringBytes = qFromLittleEndian<qint64>(data+offsetDeadStringBytes);
+    const auto* stringTable = data + headerSize + m_capacity*stationRecordSize;
+
+    // Returns the raw text at offset, or an empty string if the text is not
+    // inside the string table
+    auto rawText = [&](quint32 offset, quint32 length) {
+        if (offset + static_cast<qint64>(length) > m_stringTableSize) {
+            return QByteArray();
+        }
+        return QByteArray(reinterpret_cast<const char*>(stringTable+offset), length);
+    };
+
+    for(qint64 slot=m_capacity-1; slot>=0; slot--) {
+        const auto* record = data + headerSize + slot*stationRecordSize;
+        if (record[offsetICAOCode] == 0) {
+            m_freeSlots << slot;
+            continue;
+        }
+
+        Entry station;
+        station.slot = slot;
+        auto ICAOCode = QString::fromLatin1(reinterpret_cast<const char*>(record+offsetICAOCode), qstrnlen(reinterpret_cast<const char*>(record+offsetICAOCode), 8));
+        auto flags = qFromLittleEndian<quint32>(record+offsetFlags);
+
+        // Reports are built directly from the record. Only valid reports are
+        // ever written, so the raw texts need not be parsed again.
+        if ((flags & flagHasMETAR) != 0U) {
+            station.metarOffset = qFromLittleEndian<quint32>(record+offsetMETARText);
+            station.metarLength = qFromLittleEndian<quint32>(record+offsetMETARText+4);
+
+            auto& d = station.metar.d;
+            d->flightCategory = static_cast<Weather::METAR::FlightCategory>(record[offsetMETARFlightCategory]);
+            d->gust = Units::Speed::fromKN(qFromLittleEndian<double>(record+offsetMETARGust));
+            d->ICAOCode = ICAOCode;
+            d->location = readCoordinate(record+offsetMETARLocation);
+            d->observationTime = readTime(record+offsetMETARObservationTime);
+            d->QNH = qFromLittleEndian<quint16>(record+offsetMETARQNH);
+            d->rawText = rawText(station.metarOffset, station.metarLength);
+            d->wind = Units::Speed::fromKN(qFromLittleEndian<double>(record+offsetMETARWind));
+            d->windDirection = Units::Angle::fromDEG(qFromLittleEndian<double>(record+offsetMETARWindDirection));
+            d->messageType = ((flags & flagIsSPECI) != 0U) ? QStringLiteral("METAR/SPECI") : QStringLiteral("METAR");
+            d->parseError = d->rawText.isEmpty();
+        }
+        if ((flags & flagHasTAF) != 0U) {
+            station.tafOffset = qFromLittleEndian<quint32>(record+offsetTAFText);
+            station.tafLength = qFromLittleEndian<quint32>(record+offsetTAFText+4);
+
+            auto& d = station.taf.d;
+            d->expirationTime = readTime(record+offsetTAFExpirationTime);
+            d->ICAOCode = ICAOCode;
+            d->issueTime = readTime(record+offsetTAFIssueTime);
+            d->location = readCoordinate(record+offsetTAFLocation);
+            d->rawText = rawText(station.tafOffset, station.tafLength);
+            d->messageType = QStringLiteral("TAF");
+            d->parseError = d->rawText.isEmpty();
+        }
+        m_stations.insert(ICAOCode, station);
+    }
+
+    file.unmap(data);
+    return true;
+}
+
+
+auto Weather::WeatherCache::METARs() const -> QVector<Weather::METAR>
+{
+    QVector<Weather::METAR> result;
+    result.reserve(m_stations.size());
+    foreach(auto station, m_stations) {
+        if (station.metar.isValid()) {
+            result << station.metar;
+        }
+    }
+    return result;
+}
+
+
+auto Weather::WeatherCache::openForUpdate(QFile& file) const -> bool
+{
+    if (!file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+    auto header = file.read(headerSize);
+    if (header.size() != headerSize) {
+        return false;
+    }
+    const auto* data = reinterpret_cast<const uchar*>(header.constData());
+    return isValidCacheHeader(data, file.size())
+            && (qFromLittleEndian<qint64>(data+offsetCapacity) == m_capacity)
+            && (qFromLittleEndian<qint64>(data+offsetStringTableSize) == m_stringTableSize);
+}
+
+
+auto Weather::WeatherCache::save(const QDateTime& lastUpdate, const QVector<Weather::METAR>& METARs, const QVector<Weather::TAF>& TAFs) -> bool
+{
+    m_lastUpdate = lastUpdate;
+
+    // Collect reports by station
+    QHash<QString, Entry> stations;
+    foreach(auto metar, METARs) {
+        if (metar.isValid()) {
+            stations[metar.ICAOCode()].metar = metar;
+        }
+    }
+    foreach(auto taf, TAFs) {
+        if (taf.isValid()) {
+            stations[taf.ICAOCode()].taf = taf;
+        }
+    }
+
+    // Find stations that are new, changed or gone, and estimate the amount of
+    // unused space in the string table after the update
+    QVector<QString> changedStations;
+    QVector<QString> removedStations;
+    qint64 numNewStations = 0;
+    auto deadStringBytes = m_deadStringBytes;
+    for(auto it = stations.cbegin(); it != stations.cend(); it++) {
+        auto old = m_stations.constFind(it.key());
+        if (old == m_stations.cend()) {
+            numNewStations++;
+            changedStations << it.key();
+            continue;
+        }
+        if (!(old->metar == it->metar)) {
+            deadStringBytes += old->metarLength;
+        }
+        if (!(old->taf == it->taf)) {
+            deadStringBytes += old->tafLength;
+        }
+        if (!(old->metar == it->metar) || !(old->taf == it->taf)) {
+            changedStations << it.key();
+        }
+    }
+    for(auto it = m_stations.cbegin(); it != m_stations.cend(); it++) {
+        if (!stations.contains(it.key())) {
+            removedStations << it.key();
+            deadStringBytes += it->metarLength + it->tafLength;
+        }
+    }
+
+    // Compact if there is no room for new stations, or too much unused space
+    QFile file(m_fileName);
+    if ((numNewStations > m_freeSlots.size() + removedStations.size())
+        || (2*deadStringBytes > m_stringTableSize)
+        || !openForUpdate(file)) {
+        file.close();
+        m_stations = stations;
+        return compact();
+    }
+
+    // Remove stations that are gone
+    foreach(auto ICAOCode, removedStations) {
+        auto station = m_stations.take(ICAOCode);
+        writeStationRecord(file, {}, station);
+        m_freeSlots << station.slot;
+    }
+
+    // Write stations that are new or have changed. Raw texts are appended to
+    // the string table; the header is written last, so that an interrupted
+    // update leaves a file that can still be read.
+    auto stringTableOffset = headerSize + m_capacity*stationRecordSize;
+    foreach(auto ICAOCode, changedStations) {
+        auto& station = m_stations[ICAOCode];
+        const auto& newStation = stations[ICAOCode];
+        if (station.slot < 0) {
+            station.slot = m_freeSlots.takeLast();
+        }
+        if (!(station.metar == newStation.metar)) {
+            auto rawText = newStation.metar.d->rawText;
+            file.seek(stringTableOffset + m_stringTableSize);
+            file.write(rawText);
+            station.metar = newStation.metar;
+            station.metarOffset = m_stringTableSize;
+            station.metarLength = rawText.size();
+            m_stringTableSize += rawText.size();
+        }
+        if (!(station.taf == newStation.taf)) {
+            auto rawText = newStation.taf.d->rawText;
+            file.seek(stringTableOffset + m_stringTableSize);
+            file.write(rawText);
+            station.taf = newStation.taf;
+            station.tafOffset = m_stringTableSize;
+            station.tafLength = rawText.size();
+            m_stringTableSize += rawText.size();
+        }
+        writeStationRecord(file, ICAOCode, station);
+    }
+    m_deadStringBytes = deadStringBytes;
+    writeHeader(file);
+
+    file.close();
+    return file.error() == QFileDevice::NoError;
+}
+
+
+auto Weather::WeatherCache::TAFs() const -> QVector<Weather::TAF>
+{
+    QVector<Weather::TAF> result;
+    result.reserve(m_stations.size());
+    foreach(auto station, m_stations) {
+        if (station.taf.isValid()) {
+            result << station.taf;
+        }
+    }
+    return result;
+}
+
+
+void Weather::WeatherCache::writeHeader(QFileDevice& file) const
+{
+    uchar header[headerSize] = {};
+    memcpy(header, cacheMagic, sizeof(cacheMagic));
+    qToLittleEndian<quint32>(cacheVersion, header+offsetVersion);
+    qToLittleEndian<quint32>(stationRecordSize, header+offsetRecordSize);
+    qToLittleEndian<qint64>(m_capacity, header+offsetCapacity);
+    writeTime(m_lastUpdate, header+offsetLastUpdate);
+    qToLittleEndian<qint64>(m_stringTableSize, header+offsetStringTableSize);
+    qToLittleEndian<qint64>(m_deadStringBytes, header+offsetDeadStringBytes);
+
+    file.seek(0);
+    file.write(reinterpret_cast<const char*>(header), headerSize);
+}
+
+
+void Weather::WeatherCache::writeStationRecord(QFileDevice& file, const QString& ICAOCode, const Weather::WeatherCache::Entry& station)
+{
+    // An empty ICAO code marks a free slot
+    uchar record[stationRecordSize] = {};
+    if (!ICAOCode.isEmpty()) {
+        auto code = ICAOCode.toLatin1().left(8);
+        memcpy(record+offsetICAOCode, code.constData(), code.size());
+
+        quint32 flags = 0;
+        if (station.metar.isValid()) {
+            flags |= flagHasMETAR;
+            if (station.metar.messageType() == u"METAR/SPECI"_qs) {
+                flags |= flagIsSPECI;
+            }
+            qToLittleEndian<quint16>(station.metar.QNH(), record+offsetMETARQNH);
+            record[offsetMETARFlightCategory] = station.metar.flightCategory();
+            writeTime(station.metar.observationTime(), record+offsetMETARObservationTime);
+            writeCoordinate(station.metar.coordinate(), record+offsetMETARLocation);
+            qToLittleEndian<double>(station.metar.d->wind.toKN(), record+offsetMETARWind);
+            qToLittleEndian<double>(station.metar.d->gust.toKN(), record+offsetMETARGust);
+            qToLittleEndian<double>(station.metar.d->windDirection.toDEG(), record+offsetMETARWindDirection);
+            qToLittleEndian<quint32>(station.metarOffset, record+offsetMETARText);
+            qToLittleEndian<quint32>(station.metarLength, record+offsetMETARText+4);
+        }
+        if (station.taf.isValid()) {
+            flags |= flagHasTAF;
+            writeTime(station.taf.issueTime(), record+offsetTAFIssueTime);
+            writeTime(station.taf.expiration(), record+offsetTAFExpirationTime);
+            writeCoordinate(station.taf.coordinate(), record+offsetTAFLocation);
+            qToLittleEndian<quint32>(station.tafOffset, record+offsetTAFText);
+            qToLittleEndian<quint32>(station.tafLength, record+offsetTAFText+4);
+        }
+        qToLittleEndian<quint32>(flags, record+offsetFlags);
+    }
+
+    file.seek(headerSize + station.slot*stationRecordSize);
+    file.write(reinterpret_cast<const char*>(record), stationRecordSize);
+}
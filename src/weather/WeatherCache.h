@@ -0,0 +1,165 @@
+/***************************************************************************
+ *   Copyright (C) 2021 by Stefan Kebekus                                  *
+ *   stefan.kebekus@gmail.com                                              *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+
+#include "weather/METAR.h"
+#include "weather/TAF.h"
+
+
+namespace Weather {
+
+/*! \brief Binary cache file for weather reports
+ *
+ *  This class stores METAR and TAF reports in a compact binary file, so that
+ *  weather is available immediately when the app starts.  At startup, the
+ *  file is memory-mapped and the reports are built directly from the mapped
+ *  data. The raw texts are not parsed again and no QDataStream is involved.
+ *
+ *  The file starts with a header of headerSize bytes, containing a magic
+ *  string, the format version, the size of station records, the number of
+ *  station slots, the time of the last update and the size of the string
+ *  table.  The header is followed by a table of fixed-size station records,
+ *  one per slot, and by a string table holding the raw texts of the reports
+ *  as UTF-8.  All numbers are little endian.
+ *
+ *  Saving is incremental. Only stations whose reports have changed are
+ *  written, their raw texts are appended to the string table.  The file is
+ *  compacted, that is, rewritten from scratch, only if there are no more free
+ *  slots or if more than half of the string table is no longer used.
+ */
+class WeatherCache {
+
+public:
+    /*! \brief Default constructor
+     *
+     *  @param fileName Name of the cache file
+     */
+    explicit WeatherCache(QString fileName);
+
+    /*! \brief Size of the file header, in bytes */
+    static constexpr qint64 headerSize = 64;
+
+    /*! \brief Size of a station record, in bytes */
+    static constexpr qint64 stationRecordSize = 128;
+
+    /*! \brief Minimal number of station slots in a newly written file */
+    static constexpr qint64 minCapacity = 64;
+
+    /*! \brief Name of the cache file */
+    [[nodiscard]] auto fileName() const -> QString
+    {
+        return m_fileName;
+    }
+
+    /*! \brief Time of last update, as read by load() or written by save() */
+    [[nodiscard]] auto lastUpdate() const -> QDateTime
+    {
+        return m_lastUpdate;
+    }
+
+    /*! \brief Read the cache file
+     *
+     *  This method maps the cache file into memory and reads all reports. If
+     *  the file does not exist or is not a valid cache file, the cache is
+     *  empty.
+     *
+     *  @returns True on success
+     */
+    auto load() -> bool;
+
+    /*! \brief METARs read by load()
+     *
+     *  @returns METARs, not checked for expiration
+     */
+    [[nodiscard]] auto METARs() const -> QVector<Weather::METAR>;
+
+    /*! \brief Save reports
+     *
+     *  Stations whose reports are unchanged since the last call to load() or
+     *  save() are not touched.  Stations that do not appear in the lists are
+     *  removed from the file.
+     *
+     *  @param lastUpdate Time of last update
+     *
+     *  @param METARs List of METARs. Invalid METARs are ignored.
+     *
+     *  @param TAFs List of TAFs. Invalid TAFs are ignored.
+     *
+     *  @returns True on success
+     */
+    auto save(const QDateTime& lastUpdate, const QVector<Weather::METAR>& METARs, const QVector<Weather::TAF>& TAFs) -> bool;
+
+    /*! \brief TAFs read by load()
+     *
+     *  @returns TAFs, not checked for expiration
+     */
+    [[nodiscard]] auto TAFs() const -> QVector<Weather::TAF>;
+
+private:
+    // Content of a station slot
+    struct Entry
+    {
+        qint64 slot {-1};
+        Weather::METAR metar;
+        Weather::TAF taf;
+
+        // Location of the raw texts in the string table
+        quint32 metarOffset {0};
+        quint32 metarLength {0};
+        quint32 tafOffset {0};
+        quint32 tafLength {0};
+    };
+
+    // Rewrites the whole file, with all stations in m_stations
+    auto compact() -> bool;
+
+    // Opens the file for writing and checks that the header matches what was
+    // read or written last. Returns false if the file needs to be compacted.
+    auto openForUpdate(QFile& file) const -> bool;
+
+    // Writes header fields to the file
+    void writeHeader(QFileDevice& file) const;
+
+    // Writes the record of station to the file
+    static void writeStationRecord(QFileDevice& file, const QString& ICAOCode, const Weather::WeatherCache::Entry& station);
+
+    QString m_fileName;
+    QDateTime m_lastUpdate;
+
+    // Stations in the file, by ICAO code
+    QHash<QString, Weather::WeatherCache::Entry> m_stations;
+
+    // Number of station slots and free slots
+    qint64 m_capacity {0};
+    QVector<qint64> m_freeSlots;
+
+    // Size of the string table, and number of bytes in the string table that
+    // are no longer used
+    qint64 m_stringTableSize {0};
+    qint64 m_deadStringBytes {0};
+};
+
+} // namespace Weather
@@ -20,15 +20,18 @@
 
 #include <gsl/util>
 
-#include <QDataStream>
+#include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QLockFile>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QQmlEngine>
-#include <QSaveFile>
 #include <QStandardPaths>
+#include <QUrlQuery>
 #include <QXmlStreamReader>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtGlobal>
+#include <QtMath>
 
 #include "sunset.h"
 
@@ -37,6 +40,7 @@
 #include "navigation/Clock.h"
 #include "navigation/FlightRoute.h"
 #include "navigation/Navigator.h"
+#include "positioning/LocalTangentPlane.h"
 #include "positioning/PositionProvider.h"
 #include "weather/METAR.h"
 #include "weather/WeatherDataProvider.h"
@@ -45,7 +49,134 @@
 using namespace std::chrono_literals;
 
 
-Weather::WeatherDataProvider::WeatherDataProvider(QObject *parent) : QObject(parent)
+// Static Helper functions
+
+// Radius of the area around own position and route for which weather is
+// requested, in nautical miles
+const int requestRadiusNM = 85;
+
+// Tolerance for the simplification of the route, in meters. This is small
+// compared to the request radius.
+const double pathTolerance = Units::Distance::fromNM(5.0).toM();
+
+// Half width of the corridor along the flight route whose METARs are used by
+// corridorQNH() and corridorWind(), in meters. Stations farther away from the
+// position of a query are not used either.
+const double corridorWidth = Units::Distance::fromNM(50.0).toM();
+
+// Number of stations used for interpolation
+const qsizetype corridorNeighbours = 4;
+
+// Horizontal distance of point from the segment from a to b, in meters
+auto distanceFromSegment(const QGeoCoordinate& point, const QGeoCoordinate& a, const QGeoCoordinate& b) -> double
+{
+    Positioning::LocalTangentPlane plane(a);
+    auto enuB = plane.toENU(b);
+    auto enuPoint = plane.toENU(point);
+
+    auto length2 = enuB.east*enuB.east + enuB.north*enuB.north;
+    double t = 0.0;
+    if (length2 > 0.0) {
+        t = qBound(0.0, (enuPoint.east*enuB.east + enuPoint.north*enuB.north)/length2, 1.0);
+    }
+    auto dEast = enuPoint.east - t*enuB.east;
+    auto dNorth = enuPoint.north - t*enuB.north;
+    return qSqrt(dEast*dEast + dNorth*dNorth);
+}
+
+// Horizontal distance of point from a path, in meters. The path must not be
+// empty.
+auto distanceFromPath(const QGeoCoordinate& point, const QList<QGeoCoordinate>& path) -> double
+{
+    if (path.size() == 1) {
+        return point.distanceTo(path[0]);
+    }
+    auto result = qInf();
+    for(qsizetype i=0; i<path.size()-1; i++) {
+        result = qMin(result, distanceFromSegment(point, path[i], path[i+1]));
+    }
+    return result;
+}
+
+// Weights for inverse distance weighting of the reports of stations, as seen
+// from position. Stations that are farther away than corridorWidth get no
+// weight. If the position coincides with a station, then that station gets
+// all the weight.
+auto inverseDistanceWeights(const QGeoCoordinate& position, const QList<Weather::Station*>& stations) -> QVector<double>
+{
+    QVector<double> result(stations.size(), 0.0);
+    for(qsizetype i=0; i<stations.size(); i++) {
+        auto distance = position.distanceTo(stations[i]->coordinate());
+        if (distance < 1.0) {
+            result.fill(0.0);
+            result[i] = 1.0;
+            return result;
+        }
+        if (distance <= corridorWidth) {
+            result[i] = 1.0/(distance*distance);
+        }
+    }
+    return result;
+}
+
+// Douglas-Peucker simplification of path[first…last]. Marks the points that
+// need to be kept.
+void simplifyPath(const QList<QGeoCoordinate>& path, qsizetype first, qsizetype last, QVector<bool>& keep)
+{
+    if (last-first < 2) {
+        return;
+    }
+    qsizetype farthest = -1;
+    double maxDistance = pathTolerance;
+    for(auto i=first+1; i<last; i++) {
+        auto distance = distanceFromSegment(path[i], path[first], path[last]);
+        if (distance > maxDistance) {
+            farthest = i;
+            maxDistance = distance;
+        }
+    }
+    if (farthest < 0) {
+        return;
+    }
+    keep[farthest] = true;
+    simplifyPath(path, first, farthest, keep);
+    simplifyPath(path, farthest, last, keep);
+}
+
+// Simplified copy of path, without invalid coordinates
+auto simplifiedPath(const QList<QGeoCoordinate>& path) -> QList<QGeoCoordinate>
+{
+    QList<QGeoCoordinate> validPath;
+    foreach(auto coordinate, path) {
+        if (coordinate.isValid()) {
+            validPath << coordinate;
+        }
+    }
+    if (validPath.size() < 3) {
+        return validPath;
+    }
+
+    QVector<bool> keep(validPath.size(), false);
+    keep.first() = true;
+    keep.last() = true;
+    simplifyPath(validPath, 0, validPath.size()-1, keep);
+
+    QList<QGeoCoordinate> result;
+    for(qsizetype i=0; i<validPath.size(); i++) {
+        if (keep[i]) {
+            result << validPath[i];
+        }
+    }
+    return result;
+}
+
+
+// Member functions
+
+
+Weather::WeatherDataProvider::WeatherDataProvider(QObject *parent)
+    : QObject(parent),
+      _cache(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)+"/weather.cache")
 {
     // Connect the timer to the update method. This will set backgroundUpdate to the default value,
     // which is true. So these updates happen in the background.
@@ -59,14 +190,90 @@ Weather::WeatherDataProvider::WeatherDataProvider(QObject *parent) : QObject(par
     _deleteExiredMessagesTimer.setInterval(10min);
     _deleteExiredMessagesTimer.start();
 
-    // Update the description text when needed
+    // Rebuild the spatial indices once, after the event loop has processed
+    // all changes of station coordinates
+    _rebuildIndicesTimer.setSingleShot(true);
+    _rebuildIndicesTimer.setInterval(0);
+    connect(&_rebuildIndicesTimer, &QTimer::timeout, this, &Weather::WeatherDataProvider::rebuildStationIndex);
+    connect(&_rebuildIndicesTimer, &QTimer::timeout, this, &Weather::WeatherDataProvider::rebuildCorridorIndex);
+    connect(&_rebuildIndicesTimer, &QTimer::timeout, this, &Weather::WeatherDataProvider::QNHInfoChanged);
+
+    // Update the spatial index and the description text when needed. The
+    // index must be rebuilt first.
+    connect(this, &Weather::WeatherDataProvider::weatherStationsChanged, this, &Weather::WeatherDataProvider::rebuildStationIndex);
+    connect(this, &Weather::WeatherDataProvider::weatherStationsChanged, this, &Weather::WeatherDataProvider::rebuildCorridorIndex);
     connect(this, &Weather::WeatherDataProvider::weatherStationsChanged, this, &Weather::WeatherDataProvider::QNHInfoChanged);
 
+    // Apply parsed data when the worker is done
+    connect(&_ingestionWatcher, &QFutureWatcher<Weather::WeatherDataProvider::IngestionResult>::finished, this, &Weather::WeatherDataProvider::onIngestionFinished);
+
+    // Decoded texts depend on the application language
+    if (QCoreApplication::instance() != nullptr) {
+        QCoreApplication::instance()->installEventFilter(this);
+    }
+
     // Set up connections to other static objects, but do so with a little lag to avoid conflicts in the initialisation
     QTimer::singleShot(0, this, &Weather::WeatherDataProvider::deferredInitialization);
 }
 
 
+auto Weather::WeatherDataProvider::corridorQNH(const QGeoCoordinate& position) const -> double
+{
+    auto stations = _corridorIndex.nearest(position, corridorNeighbours, [](const Weather::Station* station) {
+        return station->hasMETAR() && (station->metar().QNH() != 0);
+    });
+    auto weights = inverseDistanceWeights(position, stations);
+
+    double totalWeight = 0.0;
+    double QNH = 0.0;
+    for(qsizetype i=0; i<stations.size(); i++) {
+        QNH += weights[i]*stations[i]->metar().QNH();
+        totalWeight += weights[i];
+    }
+    if (totalWeight <= 0.0) {
+        return qQNaN();
+    }
+    return QNH/totalWeight;
+}
+
+
+auto Weather::WeatherDataProvider::corridorWind(const QGeoCoordinate& position) const -> Weather::Wind
+{
+    auto stations = _corridorIndex.nearest(position, corridorNeighbours, [](const Weather::Station* station) {
+        if (!station->hasMETAR()) {
+            return false;
+        }
+        auto wind = station->metar().wind();
+        return wind.speed().isFinite() && wind.directionFrom().isFinite();
+    });
+    auto weights = inverseDistanceWeights(position, stations);
+
+    // Interpolate the wind vectors, in knots. Interpolating speed and
+    // direction separately would give nonsense for winds from opposite
+    // directions.
+    double totalWeight = 0.0;
+    double north = 0.0;
+    double east = 0.0;
+    for(qsizetype i=0; i<stations.size(); i++) {
+        auto wind = stations[i]->metar().wind();
+        auto speedInKN = wind.speed().toKN();
+        north += weights[i]*speedInKN*wind.directionFrom().cos();
+        east += weights[i]*speedInKN*wind.directionFrom().sin();
+        totalWeight += weights[i];
+    }
+
+    Weather::Wind result;
+    if (totalWeight <= 0.0) {
+        return result;
+    }
+    north /= totalWeight;
+    east /= totalWeight;
+    result.setSpeed(Units::Speed::fromKN(qSqrt(north*north + east*east)));
+    result.setDirectionFrom(Units::Angle::fromRAD(qAtan2(east, north)));
+    return result;
+}
+
+
 void Weather::WeatherDataProvider::deferredInitialization()
 {
     connect(GlobalObject::positionProvider(), &Positioning::PositionProvider::receivingPositionInfoChanged, this, &Weather::WeatherDataProvider::QNHInfoChanged);
@@ -75,6 +282,11 @@ void Weather::WeatherDataProvider::deferredInitialization()
     connect(GlobalObject::navigator()->clock(), &Navigation::Clock::timeChanged, this, &Weather::WeatherDataProvider::QNHInfoChanged);
     connect(GlobalObject::navigator()->clock(), &Navigation::Clock::timeChanged, this, &Weather::WeatherDataProvider::sunInfoChanged);
 
+    // Interpolated wind and QNH depend on the flight route. Route summaries
+    // depend on the interpolated wind.
+    connect(GlobalObject::navigator()->flightRoute(), &Navigation::FlightRoute::waypointsChanged, this, &Weather::WeatherDataProvider::rebuildCorridorIndex);
+    connect(this, &Weather::WeatherDataProvider::corridorChanged, GlobalObject::navigator()->flightRoute(), &Navigation::FlightRoute::summaryChanged);
+
     // Read METAR/TAF from "weather.dat"
     bool success = load();
 
@@ -88,19 +300,30 @@ void Weather::WeatherDataProvider::deferredInitialization()
 }
 
 
+auto Weather::WeatherDataProvider::eventFilter(QObject* watched, QEvent* event) -> bool
+{
+    // Handle the change later, so that the decoder has noticed the new
+    // language before QML re-reads the decoded texts
+    if (event->type() == QEvent::LanguageChange) {
+        QTimer::singleShot(0, this, &Weather::WeatherDataProvider::onLanguageChanged);
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+
 void Weather::WeatherDataProvider::deleteExpiredMesages()
 {
     QVector<QString> ICAOCodesToDelete;
 
     foreach(auto weatherStation, _weatherStationsByICAOCode) {
         if (weatherStation->hasMETAR()) {
-            if (weatherStation->metar()->expiration() < QDateTime::currentDateTime()) {
-                weatherStation->setMETAR(nullptr);
+            if (weatherStation->metar().expiration() < QDateTime::currentDateTime()) {
+                weatherStation->resetMETAR();
             }
         }
         if (weatherStation->hasTAF()) {
-            if (weatherStation->taf()->expiration() < QDateTime::currentDateTime()) {
-                weatherStation->setTAF(nullptr);
+            if (weatherStation->taf().expiration() < QDateTime::currentDateTime()) {
+                weatherStation->resetTAF();
             }
         }
 
@@ -125,6 +348,10 @@ void Weather::WeatherDataProvider::deleteExpiredMesages()
 
 auto Weather::WeatherDataProvider::downloading() const -> bool
 {
+    if (_ingestionWatcher.isRunning()) {
+        return true;
+    }
+
     foreach(auto networkReply, _networkReplies) {
         if (networkReply.isNull()) {
             continue;
@@ -149,8 +376,10 @@ void Weather::WeatherDataProvider::downloadFinished() {
     // Update flag
     emit downloadingChanged();
 
-    // Read all replies and store the data in respective maps
+    // Collect data of all replies. Parsing happens in a worker thread, so that
+    // large downloads do not block the GUI.
     bool hasError = false;
+    QList<QByteArray> replies;
     foreach(auto networkReply, _networkReplies) {
         // Paranoid safety checks
         if (networkReply.isNull()) {
@@ -161,43 +390,26 @@ void Weather::WeatherDataProvider::downloadFinished() {
             emit error(networkReply->errorString());
             continue;
         }
-
-        // Decode XML
-        QXmlStreamReader xml(networkReply);
-        while (!xml.atEnd() && !xml.hasError())
-        {
-            xml.readNext();
-
-            // Read METAR
-            if (xml.isStartElement() && (xml.name() == QStringLiteral("METAR"))) {
-                auto *metar = new Weather::METAR(xml, this);
-                findOrConstructWeatherStation(metar->ICAOCode())->setMETAR(metar);
-            }
-
-            // Read TAF
-            if (xml.isStartElement() && (xml.name() == QStringLiteral("TAF"))) {
-                auto *taf = new Weather::TAF(xml, this);
-                findOrConstructWeatherStation(taf->ICAOCode())->setTAF(taf);
-            }
-
+        auto data = networkReply->readAll();
+
+        // Skip replies whose data has not changed since the last download.
+        // The part before the element "data" contains a time stamp and is
+        // ignored.
+        auto dataSource = QUrlQuery(networkReply->request().url()).queryItemValue(QStringLiteral("dataSource"));
+        auto hash = QCryptographicHash::hash(QByteArrayView(data).sliced(qMax(static_cast<qsizetype>(0), data.indexOf("<data "))), QCryptographicHash::Sha1);
+        if (_replyHashes.value(dataSource) == hash) {
+            continue;
         }
+        _replyHashes.insert(dataSource, hash);
+        replies << data;
     }
 
     // Clear replies container
     qDeleteAll(_networkReplies);
     _networkReplies.clear();
 
-    // Update flag and signals
-    emit weatherStationsChanged();
-    emit QNHInfoChanged();
-
-    if (hasError) {
-        _updateTimer.setInterval(updateIntervalOnError_ms);
-    } else {
-        _lastUpdate = QDateTime::currentDateTimeUtc();
-        _updateTimer.setInterval(updateIntervalNormal_ms);
-        save();
-    }
+    _ingestionHasError = hasError;
+    _ingestionWatcher.setFuture(QtConcurrent::run(&Weather::WeatherDataProvider::parseReplies, replies));
 }
 
 
@@ -211,130 +423,105 @@ auto Weather::WeatherDataProvider::findOrConstructWeatherStation(const QString &
 
     auto *newWeatherStation = new Weather::Station(ICAOCode, GlobalObject::geoMapProvider(), this);
     _weatherStationsByICAOCode.insert(ICAOCode, newWeatherStation);
+    connect(newWeatherStation, &Weather::Station::coordinateChanged, &_rebuildIndicesTimer, qOverload<>(&QTimer::start));
     return newWeatherStation;
 }
 
 
 auto Weather::WeatherDataProvider::load() -> bool
 {
-    auto stdFileName = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)+"/weather.dat";
+    // Remove file written by earlier versions
+    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)+"/weather.dat");
 
     // Use LockFile. If lock could not be obtained, do nothing.
-    QLockFile lockFile(stdFileName+".lock");
+    QLockFile lockFile(_cache.fileName()+".lock");
     if (!lockFile.tryLock()) {
         return false;
     }
-
-    // Open file
-    auto inputFile = QFile(stdFileName);
-    if (!inputFile.open(QIODevice::ReadOnly)) {
-        lockFile.unlock();
+    auto success = _cache.load();
+    lockFile.unlock();
+    if (!success) {
         return false;
     }
 
-    // Generate input stream
-    QDataStream inputStream(&inputFile);
-    inputStream.setVersion(QDataStream::Qt_4_0);
-    // Check magic number and version
-    quint32 magic = 0;
-    inputStream >> magic;
-    if (magic != static_cast<quint32>(0x31415)) {
-        lockFile.unlock();
-        return false;
+    // Read time of last update and reports
+    _lastUpdate = _cache.lastUpdate();
+    foreach(auto metar, _cache.METARs()) {
+        findOrConstructWeatherStation(metar.ICAOCode())->setMETAR(metar);
     }
-    quint32 version = 0;
-    inputStream >> version;
-    if (version != static_cast<quint32>(1)) {
-        lockFile.unlock();
-        return false;
+    foreach(auto taf, _cache.TAFs()) {
+        findOrConstructWeatherStation(taf.ICAOCode())->setTAF(taf);
     }
 
-    // Read time of last update
-    inputStream >> _lastUpdate;
+    // Ok, done
+    deleteExpiredMesages();
+    emit weatherStationsChanged();
+
+    return true;
+}
 
-    // Read file
-    bool hasError = false;
-    while (!inputStream.atEnd() && (inputStream.status() == QDataStream::Ok)) {
-        QChar type;
-        inputStream >> type;
 
-        if (type == 'M') {
-            // Read METAR
-            auto *metar = new Weather::METAR(inputStream, this);
-            findOrConstructWeatherStation(metar->ICAOCode())->setMETAR(metar);
-            continue;
-        }
-        if (type == 'T') {
-            // Read TAF
-            auto *taf = new Weather::TAF(inputStream, this);
-            findOrConstructWeatherStation(taf->ICAOCode())->setTAF(taf);
-            continue;
+void Weather::WeatherDataProvider::rebuildCorridorIndex()
+{
+    // The route is simplified first. This moves the corridor by no more than
+    // pathTolerance, but saves many distance computations for routes with
+    // many waypoints.
+    auto path = simplifiedPath(GlobalObject::navigator()->flightRoute()->geoPath());
+
+    QList<Weather::Station*> stations;
+    if (!path.isEmpty()) {
+        foreach(auto station, _weatherStationsByICAOCode) {
+            if (station.isNull() || !station->hasMETAR()) {
+                continue;
+            }
+            if (distanceFromPath(station->coordinate(), path) <= corridorWidth) {
+                stations << station;
+            }
         }
-
-        // Other type? That's bad! Quit immediately!
-        hasError = true;
-        break;
     }
+    _corridorIndex.rebuild(stations);
+    emit corridorChanged();
+}
 
-    // Ok, done
-    lockFile.unlock();
-    deleteExpiredMesages();
-    emit weatherStationsChanged();
 
-    return !hasError && (inputStream.status() == QDataStream::Ok);
+void Weather::WeatherDataProvider::rebuildStationIndex()
+{
+    QList<Weather::Station*> stations;
+    stations.reserve(_weatherStationsByICAOCode.size());
+    foreach(auto station, _weatherStationsByICAOCode) {
+        if (!station.isNull()) {
+            stations << station;
+        }
+    }
+    _stationIndex.rebuild(stations);
 }
 
 
 void Weather::WeatherDataProvider::save()
 {
-    auto stdFileName = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)+"/weather.dat";
-
     // Use LockFile. If lock could not be obtained, do nothing.
-    QLockFile lockFile(stdFileName+".lock");
+    QLockFile lockFile(_cache.fileName()+".lock");
     if (!lockFile.tryLock()) {
         return;
     }
 
-    // Open file
-    auto outputFile = QSaveFile(stdFileName);
-    if (!outputFile.open(QIODevice::WriteOnly)) {
-        lockFile.unlock();
-        return;
-    }
-
-    // Generate output stream
-    QDataStream outputStream(&outputFile);
-    outputStream.setVersion(QDataStream::Qt_4_0);
-
-    // Write magic number and version
-    outputStream << static_cast<quint32>(0x31415);
-    outputStream << static_cast<quint32>(1);
-    outputStream << _lastUpdate;
-
-    // Write data
+    // Collect valid METARs and TAFs that are not yet expired
+    QVector<Weather::METAR> METARs;
+    QVector<Weather::TAF> TAFs;
     foreach(auto weatherStation, _weatherStationsByICAOCode) {
         if (weatherStation.isNull()) {
             continue;
         }
-
-        if (weatherStation->hasMETAR()) {
-            // Save only valid METARs that are not yet expired
-            if (weatherStation->metar()->isValid() && !weatherStation->metar()->isExpired()) {
-                outputStream << QChar('M');
-                weatherStation->metar()->write(outputStream);
-            }
+        if (weatherStation->hasMETAR() && !weatherStation->metar().isExpired()) {
+            METARs << weatherStation->metar();
         }
-
-        if (weatherStation->hasTAF()) {
-            // Save only valid TAFs that are not yet expired
-            if (weatherStation->taf()->isValid() && !weatherStation->taf()->isExpired()) {
-                outputStream << QChar('T');
-                weatherStation->taf()->write(outputStream);
-            }
+        if (weatherStation->hasTAF() && !weatherStation->taf().isExpired()) {
+            TAFs << weatherStation->taf();
         }
     }
 
-    outputFile.commit();
+    // Write data. Only stations that have changed are written.
+    _cache.save(_lastUpdate, METARs, TAFs);
     lockFile.unlock();
 }
 
@@ -406,45 +593,96 @@ auto Weather::WeatherDataProvider::sunInfo() -> QString
 }
 
 
-auto Weather::WeatherDataProvider::QNHInfo() const -> QString
+void Weather::WeatherDataProvider::onIngestionFinished()
 {
-    // Paranoid safety checks
-    auto *positionProvider = GlobalObject::positionProvider();
-    if (positionProvider == nullptr) {
-        return {};
-    }
-
-    // Find QNH of nearest airfield
-    Weather::Station *closestReportWithQNH = nullptr;
-    int QNH = 0;
-    foreach(auto weatherStationPtr, _weatherStationsByICAOCode) {
-        if (weatherStationPtr.isNull()) {
-            continue;
-        }
-        if (weatherStationPtr->metar() == nullptr) {
-            continue;
-        }
-        QNH = weatherStationPtr->metar()->QNH();
-        if (QNH == 0) {
+    auto result = _ingestionWatcher.result();
+
+    // Apply reports in one batch. Reports that the station already has are
+    // skipped, so that no stations are touched unnecessarily.
+    bool changed = false;
+    foreach(auto metar, result.METARs) {
+        auto* station = findWeatherStation(metar.ICAOCode());
+        if ((station != nullptr) && (station->metar() == metar)) {
             continue;
         }
-        if (!weatherStationPtr->coordinate().isValid()) {
+        findOrConstructWeatherStation(metar.ICAOCode())->setMETAR(metar);
+        changed = true;
+    }
+    foreach(auto taf, result.TAFs) {
+        auto* station = findWeatherStation(taf.ICAOCode());
+        if ((station != nullptr) && (station->taf() == taf)) {
             continue;
         }
-        if (closestReportWithQNH == nullptr) {
-            closestReportWithQNH = weatherStationPtr;
-            continue;
+        findOrConstructWeatherStation(taf.ICAOCode())->setTAF(taf);
+        changed = true;
+    }
+
+    // Update flag and signals
+    emit downloadingChanged();
+    if (changed) {
+        emit weatherStationsChanged();
+    }
+
+    if (_ingestionHasError) {
+        _updateTimer.setInterval(updateIntervalOnError_ms);
+    } else {
+        _lastUpdate = QDateTime::currentDateTimeUtc();
+        _updateTimer.setInterval(updateIntervalNormal_ms);
+        save();
+    }
+}
+
+
+void Weather::WeatherDataProvider::onLanguageChanged()
+{
+    foreach(auto station, _weatherStationsByICAOCode) {
+        if (!station.isNull()) {
+            station->onTextsChanged();
         }
+    }
+}
+
+
+auto Weather::WeatherDataProvider::parseReplies(const QList<QByteArray>& replies) -> Weather::WeatherDataProvider::IngestionResult
+{
+    IngestionResult result;
+    foreach(auto reply, replies) {
+        QXmlStreamReader xml(reply);
+        while (!xml.atEnd() && !xml.hasError())
+        {
+            xml.readNext();
+
+            // Read METAR
+            if (xml.isStartElement() && (xml.name() == QStringLiteral("METAR"))) {
+                result.METARs << Weather::METAR(xml);
+            }
 
-        QGeoCoordinate here = Positioning::PositionProvider::lastValidCoordinate();
-        if (here.distanceTo(weatherStationPtr->coordinate()) < here.distanceTo(closestReportWithQNH->coordinate())) {
-            closestReportWithQNH = weatherStationPtr;
+            // Read TAF
+            if (xml.isStartElement() && (xml.name() == QStringLiteral("TAF"))) {
+                result.TAFs << Weather::TAF(xml);
+            }
         }
     }
+    return result;
+}
+
+
+auto Weather::WeatherDataProvider::QNHInfo() const -> QString
+{
+    // Paranoid safety checks
+    auto *positionProvider = GlobalObject::positionProvider();
+    if (positionProvider == nullptr) {
+        return {};
+    }
+
+    // Find QNH of nearest airfield
+    auto* closestReportWithQNH = _stationIndex.nearest(Positioning::PositionProvider::lastValidCoordinate(), [](const Weather::Station* station) {
+        return station->hasMETAR() && (station->metar().QNH() != 0);
+    });
     if (closestReportWithQNH != nullptr) {
-        return tr("QNH: %1 hPa in %2, %3").arg(closestReportWithQNH->metar()->QNH())
+        return tr("QNH: %1 hPa in %2, %3").arg(closestReportWithQNH->metar().QNH())
                 .arg(closestReportWithQNH->ICAOCode(),
-                     Navigation::Clock::describeTimeDifference(closestReportWithQNH->metar()->observationTime()));
+                     Navigation::Clock::describeTimeDifference(closestReportWithQNH->metar().observationTime()));
     }
     return {};
 }
@@ -471,31 +709,37 @@ void Weather::WeatherDataProvider::update(bool isBackgroundUpdate) {
     qDeleteAll(_networkReplies);
     _networkReplies.clear();
 
-    // Generate queries
-    const QGeoCoordinate& position = Positioning::PositionProvider::lastValidCoordinate();
-    auto steerpts = GlobalObject::navigator()->flightRoute()->geoPath();
-    QList<QString> queries;
-    if (position.isValid()) {
-        queries.push_back(QStringLiteral("dataSource=metars&radialDistance=85;%1,%2").arg(position.longitude()).arg(position.latitude()));
-        queries.push_back(QStringLiteral("dataSource=tafs&radialDistance=85;%1,%2").arg(position.longitude()).arg(position.latitude()));
-    }
-    if (!steerpts.empty()) {
-        QString qpos;
-        foreach(auto posit, steerpts) {
-            qpos += ";" + QString::number(posit.longitude()) + "," + QString::number(posit.latitude());
+    // Generate queries. Own position and route are combined into one path,
+    // which is simplified. One query per data source covers the area around
+    // the path.
+    QList<QGeoCoordinate> path;
+    path << Positioning::PositionProvider::lastValidCoordinate();
+    path += GlobalObject::navigator()->flightRoute()->geoPath();
+    path = simplifiedPath(path);
+    QString area;
+    if (path.size() == 1) {
+        area = QStringLiteral("radialDistance=%1;%2,%3").arg(requestRadiusNM).arg(path[0].longitude()).arg(path[0].latitude());
+    }
+    if (path.size() > 1) {
+        area = QStringLiteral("flightPath=%1").arg(requestRadiusNM);
+        foreach(auto coordinate, path) {
+            area += ";" + QString::number(coordinate.longitude()) + "," + QString::number(coordinate.latitude());
         }
-        queries.push_back(QStringLiteral("dataSource=metars&flightPath=85%1").arg(qpos));
-        queries.push_back(QStringLiteral("dataSource=tafs&flightPath=85%1").arg(qpos));
     }
 
-    // Fetch data
-    foreach(auto query, queries) {
-        QUrl url = QUrl(QStringLiteral("https://www.aviationweather.gov/adds/dataserver_current/httpparam?requestType=retrieve&format=xml&hoursBeforeNow=1&mostRecentForEachStation=true&%1").arg(query));
-        QNetworkRequest request(url);
-        QPointer<QNetworkReply> reply = GlobalObject::networkAccessManager()->get(request);
-        _networkReplies.push_back(reply);
-        connect(reply, &QNetworkReply::finished, this, &Weather::WeatherDataProvider::downloadFinished);
-        connect(reply, &QNetworkReply::errorOccurred, this, &Weather::WeatherDataProvider::downloadFinished);
+    // Fetch data. The network access manager asks for gzip-compressed
+    // replies with "Accept-Encoding: gzip" and decompresses transparently.
+    if (!area.isEmpty()) {
+        const QStringList dataSources {QStringLiteral("metars"), QStringLiteral("tafs")};
+        foreach(auto dataSource, dataSources) {
+            QUrl url = _serverURL;
+            url.setQuery(QStringLiteral("requestType=retrieve&format=xml&hoursBeforeNow=1&mostRecentForEachStation=true&dataSource=%1&%2").arg(dataSource, area));
+            QNetworkRequest request(url);
+            QPointer<QNetworkReply> reply = GlobalObject::networkAccessManager()->get(request);
+            _networkReplies.push_back(reply);
+            connect(reply, &QNetworkReply::finished, this, &Weather::WeatherDataProvider::downloadFinished);
+            connect(reply, &QNetworkReply::errorOccurred, this, &Weather::WeatherDataProvider::downloadFinished);
+        }
     }
 
     // Emit "downloading" and handle the case if none of the requests have started (e.g. because
@@ -505,21 +749,6 @@ void Weather::WeatherDataProvider::update(bool isBackgroundUpdate) {
 
 
 auto Weather::WeatherDataProvider::weatherStations() const -> QList<Weather::Station *> {
-
-    // Produce a list of reports, without nullpointers
-    QList<Weather::Station *> sortedReports;
-    foreach(auto stations, _weatherStationsByICAOCode)
-        if (!stations.isNull()) {
-            sortedReports += stations;
-        }
-
-    // Sort list
-    auto compare = [&](const Weather::Station *a, const Weather::Station *b) {
-        QGeoCoordinate here = Positioning::PositionProvider::lastValidCoordinate();
-        return here.distanceTo(a->coordinate()) < here.distanceTo(b->coordinate());
-    };
-    std::sort(sortedReports.begin(), sortedReports.end(), compare);
-
-    return sortedReports;
+    return _stationIndex.sortedByDistance(Positioning::PositionProvider::lastValidCoordinate());
 }
 
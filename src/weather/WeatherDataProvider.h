@@ -20,16 +20,22 @@
 
 #pragma once
 
+#include <QFutureWatcher>
+#include <QHash>
 #include <QMap>
 #include <QPointer>
 #include <QQmlEngine>
 #include <QTimer>
+#include <QUrl>
 
 class QNetworkAccessManager;
 class QNetworkReply;
 
 #include "GlobalObject.h"
 #include "weather/Station.h"
+#include "weather/StationIndex.h"
+#include "weather/WeatherCache.h"
+#include "weather/Wind.h"
 
 class Clock;
 class FlightRoute;
@@ -101,10 +107,59 @@ public:
      */
     [[nodiscard]] auto backgroundUpdate() const -> bool { return _backgroundUpdate; };
 
+    /*! \brief QNH along the flight route
+     *
+     * This method interpolates the QNH reported in the METARs of the weather
+     * stations nearest to the given position, by inverse distance weighting.
+     * Only stations near the current flight route are considered. The query
+     * takes O(log n) time for n stations.
+     *
+     * @param position Position
+     *
+     * @returns Interpolated QNH in hPa, or NaN if no suitable station is near
+     * the position
+     */
+    Q_INVOKABLE [[nodiscard]] double corridorQNH(const QGeoCoordinate& position) const;
+
+    /*! \brief Wind along the flight route
+     *
+     * This method interpolates the wind reported in the METARs of the weather
+     * stations nearest to the given position, by inverse distance weighting
+     * of the wind vectors.  Only stations near the current flight route are
+     * considered. The query takes O(log n) time for n stations.
+     *
+     * Note that METARs report surface wind, which might differ considerably
+     * from the wind at cruise altitude.
+     *
+     * @param position Position
+     *
+     * @returns Interpolated wind. Speed and direction are NaN if no suitable
+     * station is near the position.
+     */
+    Q_INVOKABLE [[nodiscard]] Weather::Wind corridorWind(const QGeoCoordinate& position) const;
+
+    /*! \brief Weather stations used by corridorQNH() and corridorWind()
+     *
+     * This property holds the weather stations with METAR near the current
+     * flight route.  Its notifier signal is emitted whenever the results of
+     * corridorQNH() and corridorWind() might have changed, so QML bindings
+     * that use these methods can depend on this property.
+     */
+    Q_PROPERTY(QList<Weather::Station*> corridorStations READ corridorStations NOTIFY corridorChanged)
+
+    /*! \brief Getter method for property of the same name
+     *
+     * @returns Property corridorStations
+     */
+    [[nodiscard]] auto corridorStations() const -> QList<Weather::Station*>
+    {
+        return _corridorIndex.sortedByDistance({});
+    }
+
     /*! \brief Downloading flag
      *
      * Indicates that the WeatherDataProvider is currently downloading METAR/TAF
-     * information from the internet.
+     * information from the internet, or processing downloaded information.
      */
     Q_PROPERTY(bool downloading READ downloading NOTIFY downloadingChanged)
 
@@ -184,6 +239,20 @@ public:
      */
     Q_INVOKABLE void update(bool isBackgroundUpdate=true);
 
+    /*! \brief Set server
+     *
+     * By default, weather data is downloaded from the Text Data Server of the
+     * Aviation Weather Center.  This method sets a different server, for
+     * instance a local server that replays canned XML data for testing.
+     * The server must understand the same query parameters.
+     *
+     * @param serverURL URL of the server, without query
+     */
+    void setServerURL(const QUrl& serverURL)
+    {
+        _serverURL = serverURL;
+    }
+
     /*! \brief List of weather stations
      *
      * This property holds a list of all weather stations that are currently
@@ -207,6 +276,13 @@ signals:
     /*! \brief Notifier signal */
     void backgroundUpdateChanged();
 
+    /*! \brief Notifier signal
+     *
+     *  This signal is also emitted when the results of corridorQNH() and
+     *  corridorWind() might have changed.
+     */
+    void corridorChanged();
+
     /*! \brief Notifier signal */
     void downloadingChanged();
 
@@ -228,19 +304,45 @@ signals:
     /*! \brief Signal emitted when the list of weather reports changes */
     void weatherStationsChanged();
 
+protected:
+    // Watches the application object for LanguageChange events, which
+    // QCoreApplication::installTranslator() sends. See onLanguageChanged().
+    auto eventFilter(QObject* watched, QEvent* event) -> bool override;
+
 private slots:
-    // Called when a download is finished
+    // Called when a download is finished. Once all downloads are finished,
+    // this method hands the data to a worker thread, see parseReplies().
     void downloadFinished();
 
     // Check for expired METARs and TAFs and delete them.
     // This also deletes weather stations if they are no longer in use.
     void deleteExpiredMesages();
 
+    // Called when the worker thread has parsed the downloaded data. Applies
+    // all changed reports in one batch and emits notifier signals once.
+    void onIngestionFinished();
+
+    // Called after the application language has changed. Makes all weather
+    // stations emit metarChanged() and tafChanged(), so that QML re-reads
+    // the decoded texts.
+    void onLanguageChanged();
+
     // Name says it all. This method is called from the constructor,
     // but with a little lag to avoid conflicts in the initialisation of
     // static objects.
     void deferredInitialization();
 
+    // Rebuilds the spatial index of weather stations. This method is called
+    // whenever the list of weather stations changes, and once after a batch
+    // of station coordinates has changed.
+    void rebuildStationIndex();
+
+    // Rebuilds the spatial index of weather stations with METAR near the
+    // flight route. This method is called whenever the list of weather
+    // stations or the flight route changes, and once after a batch of station
+    // coordinates has changed.
+    void rebuildCorridorIndex();
+
 private:
     Q_DISABLE_COPY_MOVE(WeatherDataProvider)
 
@@ -248,39 +350,79 @@ private:
     static const int updateIntervalNormal_ms  = 30*60*1000;
     static const int updateIntervalOnError_ms =  5*60*1000;
 
+    // Reports parsed from downloaded data
+    struct IngestionResult
+    {
+        QVector<Weather::METAR> METARs;
+        QVector<Weather::TAF> TAFs;
+    };
+
+    // Reads the XML data returned by the Aviation Weather Center and parses
+    // all reports. This method does not touch any QObject and runs in a
+    // worker thread.
+    static auto parseReplies(const QList<QByteArray>& replies) -> Weather::WeatherDataProvider::IngestionResult;
+
     // Similar to findWeatherStation, but will create a weather station if no
     // station with the given code is known
     auto findOrConstructWeatherStation(const QString &ICAOCode) -> Weather::Station *;
 
-    // This method loads METAR/TAFs from a file "weather.dat" in
+    // This method loads METAR/TAFs from the cache file "weather.cache" in
     // QStandardPaths::AppDataLocation.  There is locking to ensure that no two
     // processes access the file. The method will fail silently on error.
     // Returns true on success and false on failure.
     auto load() -> bool;
 
-    // This method saves all METAR/TAFs that are valid and not yet expired to a
-    // file "weather.dat" in QStandardPaths::AppDataLocation.  There is locking
-    // to ensure that no two processes access the file. The method will fail
-    // silently on error.
+    // This method saves all METAR/TAFs that are valid and not yet expired to
+    // the cache file "weather.cache" in QStandardPaths::AppDataLocation. Only
+    // stations that have changed are written.  There is locking to ensure that
+    // no two processes access the file. The method will fail silently on
+    // error.
     void save();
 
+    // Server that weather data is downloaded from
+    QUrl _serverURL {QStringLiteral("https://www.aviationweather.gov/adds/dataserver_current/httpparam")};
+
+    // Hashes of the data in the last replies, by data source. Replies whose
+    // data has not changed are not parsed again.
+    QHash<QString, QByteArray> _replyHashes;
+
     // List of replies from aviationweather.com
     QList<QPointer<QNetworkReply>> _networkReplies;
 
+    // Worker that parses downloaded data, and error flag of the downloads
+    // whose data is being parsed
+    QFutureWatcher<Weather::WeatherDataProvider::IngestionResult> _ingestionWatcher;
+    bool _ingestionHasError {false};
+
     // A timer used for auto-updating the weather reports every 30 minutes
     QTimer _updateTimer;
 
     // A timer used for deleting expired weather reports ever 11 minutes
     QTimer _deleteExiredMessagesTimer;
 
+    // A single-shot timer with zero interval, used to rebuild the spatial
+    // indices once after the coordinates of any number of stations changed
+    QTimer _rebuildIndicesTimer;
+
     // Flag, as set by the update() method
     bool _backgroundUpdate {true};
 
     // List of weather stations, accessible by ICAO code
     QMap<QString, QPointer<Weather::Station>> _weatherStationsByICAOCode;
 
+    // Spatial index of weather stations, used by QNHInfo() and
+    // weatherStations()
+    Weather::StationIndex _stationIndex;
+
+    // Spatial index of weather stations with METAR near the flight route,
+    // used by corridorQNH() and corridorWind()
+    Weather::StationIndex _corridorIndex;
+
     // Date and Time of last update
     QDateTime _lastUpdate;
+
+    // Cache file for weather reports
+    Weather::WeatherCache _cache;
 };
 
 